@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "MatrixOperations.h"
+
+// Bounding volumes of a mesh, in its local space. Mesh::Setup fills them from the vertices,
+// Frustum.h tests them (moved by the model matrix) against the view.
+class AABB {
+	public:
+    vec3 min, max;
+    vec3 Center() const { return vec3((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f); }
+    vec3 Extents() const { return vec3((max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f); }
+};
+
+class BoundingSphere {
+	public:
+    vec3 center;
+    float radius = 0.0f;
+};
+
+// From interleaved vertices, position at offset 0 of every stride floats.
+// The sphere is centered on the box and just reaches the farthest vertex (tighter than the box corner).
+inline void ComputeBounds(const std::vector<float>& vertices, size_t stride, AABB& box, BoundingSphere& sphere) {
+    box = AABB();
+    sphere = BoundingSphere();
+    if (vertices.size() < 3 || stride < 3) return;
+    box.min = box.max = vec3(vertices[0], vertices[1], vertices[2]);
+    for (size_t i = 0; i + 2 < vertices.size(); i += stride) {
+        box.min.x = std::min(box.min.x, vertices[i]);     box.max.x = std::max(box.max.x, vertices[i]);
+        box.min.y = std::min(box.min.y, vertices[i + 1]); box.max.y = std::max(box.max.y, vertices[i + 1]);
+        box.min.z = std::min(box.min.z, vertices[i + 2]); box.max.z = std::max(box.max.z, vertices[i + 2]);
+    }
+    sphere.center = box.Center();
+    float radius2 = 0.0f;
+    for (size_t i = 0; i + 2 < vertices.size(); i += stride) {
+        float dx = vertices[i] - sphere.center.x, dy = vertices[i + 1] - sphere.center.y, dz = vertices[i + 2] - sphere.center.z;
+        radius2 = std::max(radius2, dx * dx + dy * dy + dz * dz);
+    }
+    sphere.radius = std::sqrt(radius2);
+}
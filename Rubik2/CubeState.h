@@ -0,0 +1,287 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <numeric>
+#include <cstdlib>
+
+/*
+Compact 3x3x3 state: a permutation of the 54 facelets (one byte each).
+No GL, no Mesh - usable from tools and tests.
+
+Facelet order is Kociemba's: U1..U9 R1..R9 F1..F9 D1..D9 L1..L9 B1..B9,
+the same layout RubikCube's state string and solver2.py use.
+
+dest[i] = where the sticker that started on facelet i is now.
+Moves are generated from the geometry (cubie position + sticker normal),
+so slice moves, wide moves and whole cube rotations come for free.
+*/
+
+const int FACELET_COUNT = 54;
+const char FACE_NAMES[6] = { 'U', 'R', 'F', 'D', 'L', 'B' };
+
+class Facelet {
+public:
+    int pos[3];    // cubie position, each in -1..1
+    int normal[3]; // sticker direction
+};
+
+// Quarter turn (+90 degrees, right hand rule) of a vector around an axis (0 = X, 1 = Y, 2 = Z)
+inline void RotateQuarter(int v[3], int axis) {
+    int x = v[0], y = v[1], z = v[2];
+    switch (axis) {
+        case 0: v[1] = -z; v[2] = y; break;
+        case 1: v[0] = z; v[2] = -x; break;
+        case 2: v[0] = -y; v[1] = x; break;
+    }
+}
+
+class FaceletTables {
+public:
+    std::array<Facelet, FACELET_COUNT> facelets;
+
+    FaceletTables() {
+        for (int f = 0; f < 6; ++f) {
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 3; ++c) {
+                    Facelet& fl = facelets[f * 9 + r * 3 + c];
+                    int* p = fl.pos;
+                    int* n = fl.normal;
+                    n[0] = n[1] = n[2] = 0;
+                    // Net layout, each face seen from outside
+                    switch (FACE_NAMES[f]) {
+                        case 'U': p[0] = c - 1; p[1] = 1;     p[2] = r - 1; n[1] = 1;  break;
+                        case 'R': p[0] = 1;     p[1] = 1 - r; p[2] = 1 - c; n[0] = 1;  break;
+                        case 'F': p[0] = c - 1; p[1] = 1 - r; p[2] = 1;     n[2] = 1;  break;
+                        case 'D': p[0] = c - 1; p[1] = -1;    p[2] = 1 - r; n[1] = -1; break;
+                        case 'L': p[0] = -1;    p[1] = 1 - r; p[2] = c - 1; n[0] = -1; break;
+                        case 'B': p[0] = 1 - c; p[1] = 1 - r; p[2] = -1;    n[2] = -1; break;
+                    }
+                }
+            }
+        }
+    }
+
+    int Find(const int pos[3], const int normal[3]) const {
+        for (int i = 0; i < FACELET_COUNT; ++i) {
+            const Facelet& f = facelets[i];
+            if (f.pos[0] == pos[0] && f.pos[1] == pos[1] && f.pos[2] == pos[2] &&
+                f.normal[0] == normal[0] && f.normal[1] == normal[1] && f.normal[2] == normal[2])
+                return i;
+        }
+        return -1;
+    }
+
+    // Permutation of a +90 degree turn of the layers in [minLayer, maxLayer] around axis
+    std::array<uint8_t, FACELET_COUNT> QuarterTurn(int axis, int minLayer, int maxLayer) const {
+        std::array<uint8_t, FACELET_COUNT> perm;
+        for (int i = 0; i < FACELET_COUNT; ++i) {
+            Facelet f = facelets[i];
+            int layer = f.pos[axis];
+            if (layer >= minLayer && layer <= maxLayer) {
+                RotateQuarter(f.pos, axis);
+                RotateQuarter(f.normal, axis);
+            }
+            perm[i] = (uint8_t)Find(f.pos, f.normal);
+        }
+        return perm;
+    }
+
+    static const FaceletTables& Get() {
+        static const FaceletTables tables;
+        return tables;
+    }
+};
+
+class CubeState {
+public:
+    std::array<uint8_t, FACELET_COUNT> dest;
+
+    CubeState() { Reset(); }
+
+    void Reset() {
+        for (int i = 0; i < FACELET_COUNT; ++i) dest[i] = (uint8_t)i;
+    }
+    bool IsSolved() const {
+        for (int i = 0; i < FACELET_COUNT; ++i)
+            if (dest[i] != i) return false;
+        return true;
+    }
+    // this, then perm
+    void Apply(const std::array<uint8_t, FACELET_COUNT>& perm) {
+        for (int i = 0; i < FACELET_COUNT; ++i) dest[i] = perm[dest[i]];
+    }
+    void Apply(const CubeState& other) { Apply(other.dest); }
+
+    // Facelet string (URFDLB letters) of this permutation applied to a solved cube
+    std::string ToFaceletString() const {
+        std::string out(FACELET_COUNT, '?');
+        for (int i = 0; i < FACELET_COUNT; ++i) out[dest[i]] = FACE_NAMES[i / 9];
+        return out;
+    }
+};
+
+/*
+One move of standard notation: U R F D L B (clockwise seen from that face),
+M E S slices, x y z rotations, wide moves as "Rw" or "r".
+Suffix: ' for inverse, a number for repeats ("U2", "R2'", "U3").
+*/
+class MoveTable {
+public:
+    // perms[letter][quarterTurns - 1], quarterTurns = 1..3
+    std::array<std::array<std::array<uint8_t, FACELET_COUNT>, 3>, 128> perms;
+    std::array<bool, 128> known{};
+
+    MoveTable() {
+        const FaceletTables& t = FaceletTables::Get();
+        // letter, axis, min layer, max layer, +90 turns that make one clockwise turn (1 or 3)
+        struct Def { char c; int axis, lo, hi, turns; };
+        const Def defs[] = {
+            { 'R', 0,  1,  1, 3 }, { 'L', 0, -1, -1, 1 }, { 'M', 0,  0,  0, 1 },
+            { 'U', 1,  1,  1, 3 }, { 'D', 1, -1, -1, 1 }, { 'E', 1,  0,  0, 1 },
+            { 'F', 2,  1,  1, 3 }, { 'B', 2, -1, -1, 1 }, { 'S', 2,  0,  0, 3 },
+            { 'x', 0, -1,  1, 3 }, { 'y', 1, -1,  1, 3 }, { 'z', 2, -1,  1, 3 },
+            { 'r', 0,  0,  1, 3 }, { 'l', 0, -1,  0, 1 },
+            { 'u', 1,  0,  1, 3 }, { 'd', 1, -1,  0, 1 },
+            { 'f', 2,  0,  1, 3 }, { 'b', 2, -1,  0, 1 },
+        };
+        for (const Def& d : defs) {
+            std::array<uint8_t, FACELET_COUNT> quarter = t.QuarterTurn(d.axis, d.lo, d.hi);
+            CubeState s;
+            for (int q = 0; q < 3; ++q) {
+                for (int k = 0; k < d.turns; ++k) s.Apply(quarter);
+                perms[(int)d.c][q] = s.dest;
+            }
+            known[(int)d.c] = true;
+        }
+    }
+
+    static const MoveTable& Get() {
+        static const MoveTable table;
+        return table;
+    }
+};
+
+// Parse an algorithm and apply it to state. Returns false (and sets error) on an unknown token.
+// Parentheses, brackets and whitespace are ignored.
+inline bool ApplyAlgorithm(CubeState& state, const std::string& alg, std::string* error = nullptr) {
+    const MoveTable& table = MoveTable::Get();
+    size_t i = 0;
+    while (i < alg.size()) {
+        char c = alg[i];
+        if (c == ' ' || c == '\t' || c == '(' || c == ')' || c == '[' || c == ']' || c == '\r' || c == ',') { ++i; continue; }
+        if ((unsigned char)c >= 128 || !table.known[(int)c]) {
+            if (error) *error = std::string("unknown move '") + c + "' at " + std::to_string(i);
+            return false;
+        }
+        ++i;
+        // Rw == r
+        if (i < alg.size() && alg[i] == 'w' && c >= 'A' && c <= 'Z' && c != 'M' && c != 'E' && c != 'S') {
+            c = (char)(c - 'A' + 'a');
+            ++i;
+        }
+        int count = 0;
+        while (i < alg.size() && alg[i] >= '0' && alg[i] <= '9') count = count * 10 + (alg[i++] - '0');
+        if (count == 0) count = 1;
+        if (i < alg.size() && alg[i] == '\'') { count = -count; ++i; }
+        int quarters = ((count % 4) + 4) % 4;
+        if (quarters != 0) state.Apply(table.perms[(int)c][quarters - 1]);
+    }
+    return true;
+}
+
+/*
+Properties of one algorithm, computed from its permutation.
+Pieces are named by their faces (UFR, UF, U), cycles are written like (UFR UBR ULB)
+and get a suffix when the pieces come back twisted/flipped: + or - for corner twist, ~ for edge flip.
+*/
+class AlgorithmInfo {
+public:
+    long long order = 1;              // repetitions until the cube is solved again
+    bool cornerOddParity = false;     // corner permutation parity
+    bool edgeOddParity = false;       // edge permutation parity (differs from the corners' after slice moves)
+    std::vector<std::string> cornerCycles;
+    std::vector<std::string> edgeCycles;
+    std::vector<std::string> centerCycles;
+    int cornersAffected = 0, edgesAffected = 0, centersAffected = 0;
+};
+
+inline std::string PieceName(const int pos[3]) {
+    std::string name;
+    if (pos[1] != 0) name += pos[1] > 0 ? 'U' : 'D';
+    if (pos[2] != 0) name += pos[2] > 0 ? 'F' : 'B';
+    if (pos[0] != 0) name += pos[0] > 0 ? 'R' : 'L';
+    return name;
+}
+
+inline AlgorithmInfo AnalyzeState(const CubeState& state) {
+    const FaceletTables& t = FaceletTables::Get();
+    AlgorithmInfo info;
+
+    // Facelet cycles -> order
+    std::array<bool, FACELET_COUNT> seen{};
+    for (int i = 0; i < FACELET_COUNT; ++i) {
+        if (seen[i]) continue;
+        long long len = 0;
+        for (int j = i; !seen[j]; j = state.dest[j]) { seen[j] = true; ++len; }
+        info.order = info.order / std::gcd(info.order, len) * len;
+    }
+
+    // Piece cycles. A piece is identified by its (home) position, 27 slots in a 3x3x3 grid.
+    auto slot = [](const int p[3]) { return (p[0] + 1) * 9 + (p[1] + 1) * 3 + (p[2] + 1); };
+    std::array<int, 27> anyFacelet;
+    anyFacelet.fill(-1);
+    for (int i = 0; i < FACELET_COUNT; ++i) anyFacelet[slot(t.facelets[i].pos)] = i;
+
+    std::array<bool, 27> pieceSeen{};
+    int cornerTranspositions = 0, edgeTranspositions = 0;
+    for (int home = 0; home < 27; ++home) {
+        int f0 = anyFacelet[home];
+        if (f0 < 0 || pieceSeen[home]) continue;
+        // Follow the piece until it comes back to its home slot
+        std::vector<int> cycle;
+        int f = f0;
+        int s = home;
+        do {
+            pieceSeen[s] = true;
+            cycle.push_back(f);
+            f = state.dest[f];
+            s = slot(t.facelets[f].pos);
+        } while (s != home);
+        const Facelet& homeFacelet = t.facelets[f0];
+        int kind = std::abs(homeFacelet.pos[0]) + std::abs(homeFacelet.pos[1]) + std::abs(homeFacelet.pos[2]); // 3 corner, 2 edge, 1 center
+        bool moved = (cycle.size() > 1) || (f != f0);
+        if (!moved) continue;
+
+        if (kind == 3) info.cornersAffected += (int)cycle.size();
+        else if (kind == 2) info.edgesAffected += (int)cycle.size();
+        else info.centersAffected += (int)cycle.size();
+
+        std::string text = "(";
+        for (size_t k = 0; k < cycle.size(); ++k) {
+            if (k) text += ' ';
+            text += PieceName(t.facelets[cycle[k]].pos);
+        }
+        text += ')';
+        if (f != f0) {
+            // Came back on a different sticker: twisted (corner) or flipped (edge)
+            if (kind == 3) {
+                // Seen from outside the corner, clockwise turns n0 -> n1 against the right hand rule around pos
+                const int* n0 = homeFacelet.normal;
+                const int* n1 = t.facelets[f].normal;
+                const int* p = homeFacelet.pos;
+                int c[3] = { n0[1] * n1[2] - n0[2] * n1[1], n0[2] * n1[0] - n0[0] * n1[2], n0[0] * n1[1] - n0[1] * n1[0] };
+                text += (c[0] * p[0] + c[1] * p[1] + c[2] * p[2] < 0) ? "+" : "-";
+            } else {
+                text += "~";
+            }
+        }
+        if (kind == 3) { info.cornerCycles.push_back(text); cornerTranspositions += (int)cycle.size() - 1; }
+        else if (kind == 2) { info.edgeCycles.push_back(text); edgeTranspositions += (int)cycle.size() - 1; }
+        else info.centerCycles.push_back(text);
+    }
+    info.cornerOddParity = (cornerTranspositions % 2) != 0;
+    info.edgeOddParity = (edgeTranspositions % 2) != 0;
+    return info;
+}
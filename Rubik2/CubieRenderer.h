@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include "Shader.h"
+#include "StickerRenderer.h"
+#include "TransformStore.h"
+#include "Frustum.h"
+
+/*
+Instanced renderer for the cubies of a normal sized cube.
+Every cubie is an instance of ONE shared unit cube (UVs 0..1 on each face), so cubies
+themselves own no GL objects. Per instance we send, from two buffers:
+ - model matrix: straight from the TransformStore's models array, one upload
+ - the palette colors of its 6 faces, packed 3 bits each into one uint (see PackFaceColors)
+   and the selected flag (for the slice highlight)
+The whole cube is then a single glDrawElementsInstanced instead of 2-3 GL calls per cubie.
+*/
+
+// Six 3-bit palette indices, face f (CubieFace order) in bits 3f..3f+2
+inline unsigned int PackFaceColors(const int colors[6]) {
+    unsigned int packed = 0;
+    for (int f = 0; f < 6; ++f) packed |= (unsigned int)(colors[f] & 7) << (3 * f);
+    return packed;
+}
+inline int UnpackFaceColor(unsigned int packed, int face) {
+    return (int)((packed >> (3 * face)) & 7u);
+}
+
+// Per-instance data besides the model matrix
+class CubieInstance {
+public:
+    unsigned int faceColors; // packed, see PackFaceColors
+    float selected;
+};
+
+class CubieRenderer {
+public:
+    std::vector<CubieInstance> instances;
+    const Mesh* cube = nullptr; // shared (MeshRegistry)
+    unsigned int VAO = 0;       // ours: the cube's buffers + the instance attributes
+    unsigned int modelVBO = 0;    // mat4 per instance, a copy of TransformStore::models
+    unsigned int instanceVBO = 0; // CubieInstance per instance
+    size_t instanceCount = 0;
+    size_t drawCount = 0;   // instances in the buffers right now (all, or the visible ones after Cull)
+    bool compacted = false; // the buffers hold only the visible instances
+    bool dirty = true; // instance data must be rebuilt before the next draw
+    bool pending = false; // instance data rebuilt, not uploaded yet (Cull does)
+
+    // GL objects, call once a context exists
+    void Setup() {
+        const UVRange full = { 0.0f, 0.0f, 1.0f, 1.0f };
+        cube = &MeshRegistry::RubikCubie(full, full, full, full, full, full);
+        VAO = cube->CreateVertexArray();
+        glGenBuffers(1, &modelVBO);
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, modelVBO);
+        // mat4 = 4 vec4 attributes (locations 3..6)
+        for (int col = 0; col < 4; ++col) {
+            glVertexAttribPointer(3 + col, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(col * 4 * sizeof(float)));
+            glEnableVertexAttribArray(3 + col);
+            glVertexAttribDivisor(3 + col, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        const int stride = sizeof(CubieInstance);
+        // Packed face colors, integer attribute (no conversion to float)
+        glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, stride, (void*)0);
+        glEnableVertexAttribArray(7);
+        glVertexAttribDivisor(7, 1);
+        glVertexAttribPointer(8, 1, GL_FLOAT, GL_FALSE, stride, (void*)sizeof(unsigned int)); // selected
+        glEnableVertexAttribArray(8);
+        glVertexAttribDivisor(8, 1);
+        glBindVertexArray(0);
+    }
+
+    // Rebuild the instance data: one instance per transform, the models array goes up as is.
+    // Nothing is uploaded here, Cull sends either all of it or only the visible part.
+    // For cubie i (of count): handle(i) -> its transform, faceColors(i) -> packed colors, selected(i) -> bool
+    template <typename HandleFn, typename ColorFn, typename SelectedFn>
+    void UpdateInstances(const TransformStore& transforms, size_t count, HandleFn handle, ColorFn faceColors, SelectedFn selected) {
+        instanceCount = transforms.Size();
+        instances.resize(instanceCount);
+        for (size_t i = 0; i < count; ++i) {
+            CubieInstance& instance = instances[handle((int)i)];
+            instance.faceColors = faceColors((int)i);
+            instance.selected = selected((int)i) ? 1.0f : 0.0f;
+        }
+        pending = true;
+        dirty = false;
+    }
+
+    // Frustum culling over the instances, then at most one upload before the draw. With everything
+    // in view (the usual case) the full buffers go up, and only when they changed; otherwise only the
+    // visible instances are uploaded and drawn. A still camera over still cubies uploads nothing: the
+    // buffers are kept while the instances were not rebuilt and the same ones are visible.
+    void Cull(const TransformStore& transforms, const Frustum& frustum) {
+        size_t visibleCount = CullInstances(frustum, cube->boundingSphere, transforms.models.data(), instanceCount, 16, visible);
+        CullStats::Count(visibleCount, instanceCount - visibleCount);
+        if (visibleCount == instanceCount) {
+            if (pending || compacted) Upload(transforms.models.data(), instances.data(), instanceCount);
+            compacted = false;
+            pending = false;
+            return;
+        }
+        if (!pending && compacted && visible == uploadedVisible) return;
+        visibleModels.resize(visibleCount * 16);
+        visibleInstances.resize(visibleCount);
+        for (size_t i = 0; i < visibleCount; ++i) {
+            const float* model = transforms.Model(visible[i]);
+            std::copy(model, model + 16, visibleModels.begin() + i * 16);
+            visibleInstances[i] = instances[visible[i]];
+        }
+        Upload(visibleModels.data(), visibleInstances.data(), visibleCount);
+        uploadedVisible = visible;
+        compacted = true;
+        pending = false;
+    }
+
+    // One draw call for every (visible) cubie
+    void Draw(const Shader& shader) const {
+        if (drawCount == 0) return;
+        shader.use();
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)cube->indices.size(), GL_UNSIGNED_INT, 0, (GLsizei)drawCount);
+    }
+
+private:
+    // Scratch for Cull, keeps its capacity
+    std::vector<int> visible;
+    std::vector<int> uploadedVisible; // the visible list in the compacted buffers
+    std::vector<float> visibleModels;
+    std::vector<CubieInstance> visibleInstances;
+
+    void Upload(const float* models, const CubieInstance* data, size_t count) {
+        // Orphan + refill, the driver does not have to wait for the previous frame
+        glBindBuffer(GL_ARRAY_BUFFER, modelVBO);
+        glBufferData(GL_ARRAY_BUFFER, count * 16 * sizeof(float), models, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(CubieInstance), data, GL_STREAM_DRAW);
+        drawCount = count;
+    }
+};
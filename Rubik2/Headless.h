@@ -0,0 +1,180 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "Mesh.h"
+#ifdef RUBIK_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+/*
+Headless mode: no window, no display, no GPU needed.
+The cube is drawn into an offscreen framebuffer, frames can be written as PNG and every frame
+reports its CPU and GPU time. With Mesa's llvmpipe this runs on any build/test machine:
+
+    Rubik2_glfw --headless --moves "R U R' U'" --out frames --every 5
+
+The GL context comes from EGL (Mesa surfaceless platform, no window system at all).
+Needs a build with -DRUBIK_HEADLESS=ON, which links libEGL.
+*/
+
+class HeadlessOptions {
+public:
+    bool enabled = false;
+    std::string moves;          // played like a solver solution
+    std::string outDir = "frames";
+    int cubeSize = 3;
+    int width = 800;
+    int height = 600;
+    float frameTime = 1.0f / 60.0f; // simulated seconds per frame
+    int saveEvery = 1;          // write every n-th frame as PNG, 0 = only timings
+    int maxFrames = 10000;
+
+    // Returns false (after printing the usage) on bad arguments in headless mode.
+    // Without --headless anything unknown is left alone, the windowed app takes no arguments of its own.
+    bool Parse(int argc, char** argv) {
+        bool unknown = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--headless") enabled = true;
+            else if (arg == "--moves" && hasValue) moves = argv[++i];
+            else if (arg == "--out" && hasValue) outDir = argv[++i];
+            else if (arg == "--cube" && hasValue) cubeSize = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--width" && hasValue) width = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--height" && hasValue) height = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--dt" && hasValue) frameTime = (float)std::atof(argv[++i]);
+            else if (arg == "--every" && hasValue) saveEvery = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "--max-frames" && hasValue) maxFrames = std::max(1, std::atoi(argv[++i]));
+            else unknown = true;
+        }
+        if (enabled && unknown) {
+            PrintUsage();
+            return false;
+        }
+        return true;
+    }
+    static void PrintUsage() {
+        std::cerr << "Usage: Rubik2_glfw [--headless] [--moves \"R U R' U'\"] [--cube N] [--out dir]\n"
+                  << "                   [--width W] [--height H] [--dt seconds] [--every n] [--max-frames n]\n";
+    }
+};
+
+#ifdef RUBIK_HEADLESS
+// Makes a GL 3.3 core context current without any surface. Surfaceless Mesa platform first,
+// the default display as fallback (drivers without EGL_MESA_platform_surfaceless).
+inline bool CreateHeadlessContext() {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "EGL: no display\n";
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL: desktop OpenGL not supported\n";
+        return false;
+    }
+    // We never draw to an EGL surface, any GL capable config will do (or none, with KHR_no_config_context)
+    const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+        config = nullptr; // EGL_NO_CONFIG_KHR
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "EGL: cannot create a GL 3.3 core context\n";
+        return false;
+    }
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "EGL: surfaceless contexts not supported\n";
+        return false;
+    }
+    if (!gladLoadGL((GLADloadfunc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        return false;
+    }
+    std::cout << "Headless EGL " << major << "." << minor << ", renderer: " << glGetString(GL_RENDERER) << "\n";
+    return true;
+}
+#endif
+
+// Color + depth framebuffer to draw into instead of a window
+class OffscreenTarget {
+public:
+    unsigned int FBO = 0, colorRBO = 0, depthRBO = 0;
+    int width = 0, height = 0;
+
+    bool Setup(int w, int h) {
+        width = w; height = h;
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glGenRenderbuffers(1, &colorRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+        glGenRenderbuffers(1, &depthRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+        glViewport(0, 0, w, h);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Offscreen framebuffer incomplete\n";
+            return false;
+        }
+        return true;
+    }
+    // Current contents as a PNG (GL rows go bottom up, PNG rows top down)
+    bool SavePNG(const std::string& path) {
+        std::vector<unsigned char> pixels((size_t)width * height * 4);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        stbi_flip_vertically_on_write(1);
+        return stbi_write_png(path.c_str(), width, height, 4, pixels.data(), width * 4) != 0;
+    }
+};
+
+// GPU time between Begin and End, from two GL_TIMESTAMP queries (core since 3.3).
+// Timestamps rather than GL_TIME_ELAPSED: llvmpipe returns garbage for the first elapsed query.
+// Software rasterizers only time the command recording here, the pixels are drawn in glFinish,
+// so the runner reports the glFinish wait as well.
+class GpuTimer {
+public:
+    unsigned int queries[2] = { 0, 0 };
+
+    void Setup() { glGenQueries(2, queries); }
+    void Begin() { glQueryCounter(queries[0], GL_TIMESTAMP); }
+    void End() { glQueryCounter(queries[1], GL_TIMESTAMP); }
+    // Waits for the GPU to finish the frame
+    double Milliseconds() const {
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+        return (end - start) / 1.0e6;
+    }
+};
+
+class FrameTiming {
+public:
+    int frame;
+    double cpuMs;   // Update + draw submission
+    double gpuMs;   // GPU timestamps around the draw
+    double finishMs; // glFinish wait, where a software rasterizer does the drawing
+    double saveMs;  // readback + PNG encoding, 0 if the frame was not saved
+};
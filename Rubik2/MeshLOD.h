@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "Mesh.h"
+
+/*
+Level of detail chain of one primitive: the same shape at falling tessellation, finest first.
+Every level knows its geometric error (how far its flat facets get from the true curved surface,
+in object units); per draw the coarsest level whose error stays under MAX_PIXEL_ERROR on screen
+is picked. Far or small objects get few triangles, close-ups keep the full tessellation.
+Levels are shared meshes (MeshRegistry builds the chains).
+*/
+
+// Largest on-screen deviation allowed from the true surface, in pixels
+const float LOD_MAX_PIXEL_ERROR = 0.5f;
+
+// Pixels covered by one object unit at distance from the eye (perspective projection,
+// m[5] = 1 / tan(fov / 2) maps half the viewport height)
+inline float PixelsPerUnit(const matrix4& projection, float viewportHeight, float distance) {
+    return projection.m[5] * 0.5f * viewportHeight / std::max(distance, 1e-4f);
+}
+
+// Deviation of a chord over angle radians from its arc of radius r (the sagitta)
+inline float ChordError(float r, float angle) {
+    return r * (1.0f - std::cos(angle * 0.5f));
+}
+
+class MeshLOD {
+public:
+    class Level {
+    public:
+        const Mesh* mesh;
+        float error; // object units
+    };
+    std::vector<Level> levels; // finest first
+
+    // Level to draw when one object unit covers pixelsPerUnit pixels
+    const Mesh& Select(float pixelsPerUnit) const {
+        size_t chosen = 0;
+        while (chosen + 1 < levels.size() && levels[chosen + 1].error * pixelsPerUnit <= LOD_MAX_PIXEL_ERROR) ++chosen;
+        return *levels[chosen].mesh;
+    }
+    // Same, for an object whose bounds are centered at worldCenter, drawn scaled by scale
+    // (errors and bounds are in object units, a unit mesh grows to its size in the model matrix)
+    const Mesh& Select(const matrix4& projection, float viewportHeight, const vec3& eye, const vec3& worldCenter,
+                       float scale = 1.0f) const {
+        vec3 d(worldCenter.x - eye.x, worldCenter.y - eye.y, worldCenter.z - eye.z);
+        // Distance to the nearest point of the bounds, the part of the object that looks biggest
+        float distance = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z) - levels[0].mesh->boundingSphere.radius * scale;
+        return Select(PixelsPerUnit(projection, viewportHeight, distance) * scale);
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <initializer_list>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include "Mesh.h"
+#include "MeshLOD.h"
+#include "Hash.h"
+
+/*
+Generated primitive meshes, shared. A generator with the same parameters is built and uploaded
+once; asking again hands back the same mesh (VAO, buffers, bounds), so setting a scene up again
+costs a hash lookup: no vertex building, no GL buffers, no heap allocation.
+Shared meshes are const: draw them, never UpdateVertices them. A renderer that adds its own
+per-instance attributes takes its own VAO over the shared buffers (Mesh::CreateVertexArray).
+Meshes live until the program ends, so keys hold shapes, not sizes: a size that changes at run
+time (the Tetris floor radius) goes in the model matrix over a unit mesh.
+*/
+
+enum class MeshGenerator { RubikCubie, UnitQuad };
+
+// Generator + its parameters as floats, compared bit for bit
+class MeshKey {
+public:
+    static const int MAX_PARAMS = 28;
+    MeshGenerator generator;
+    int count = 0;
+    float params[MAX_PARAMS] = {};
+
+    MeshKey(MeshGenerator g, std::initializer_list<float> values) : generator(g) {
+        for (float v : values)
+            if (count < MAX_PARAMS) params[count++] = v;
+    }
+    bool operator==(const MeshKey& other) const {
+        return generator == other.generator && count == other.count && std::memcmp(params, other.params, count * sizeof(float)) == 0;
+    }
+    class Hash {
+    public:
+        size_t operator()(const MeshKey& key) const {
+            // The generator, then the parameter bits
+            uint64_t hash = Fnv1a(&key.generator, sizeof(key.generator));
+            return (size_t)Fnv1a(key.params, key.count * sizeof(float), hash);
+        }
+    };
+};
+
+class MeshRegistry {
+public:
+    static inline int generated = 0;
+    static inline int reused = 0;
+
+    // The mesh for key, made by generate() the first time only
+    template <typename Generate>
+    static const Mesh& Get(const MeshKey& key, Generate generate) {
+        auto found = meshes.find(key);
+        if (found != meshes.end()) {
+            reused++;
+            return *found->second;
+        }
+        generated++;
+        auto inserted = meshes.emplace(key, std::make_unique<Mesh>(generate()));
+        return *inserted.first->second;
+    }
+    // The LOD chain for key, filled by build(chain) the first time only
+    template <typename Build>
+    static const MeshLOD& GetLOD(const MeshKey& key, Build build) {
+        auto found = chains.find(key);
+        if (found != chains.end()) return *found->second;
+        auto chain = std::make_unique<MeshLOD>();
+        build(*chain);
+        return *chains.emplace(key, std::move(chain)).first->second;
+    }
+
+    static const Mesh& RubikCubie(const UVRange& front, const UVRange& back, const UVRange& left, const UVRange& right,
+                                  const UVRange& bottom, const UVRange& top) {
+        MeshKey key(MeshGenerator::RubikCubie, {
+            front.uMin, front.vMin, front.uMax, front.vMax, back.uMin, back.vMin, back.uMax, back.vMax,
+            left.uMin, left.vMin, left.uMax, left.vMax, right.uMin, right.vMin, right.uMax, right.vMax,
+            bottom.uMin, bottom.vMin, bottom.uMax, bottom.vMax, top.uMin, top.vMin, top.uMax, top.vMax });
+        return Get(key, [&] { return CreateRubikCubieMesh(front, back, left, right, bottom, top); });
+    }
+    static const Mesh& UnitQuad() {
+        return Get(MeshKey(MeshGenerator::UnitQuad, {}), [] { return CreateUnitQuad(); });
+    }
+    static void PrintStats() {
+        std::cout << "Meshes: " << generated << " generated, " << reused << " reused\n";
+    }
+
+private:
+    static inline std::unordered_map<MeshKey, std::unique_ptr<Mesh>, MeshKey::Hash> meshes;
+    static inline std::unordered_map<MeshKey, std::unique_ptr<MeshLOD>, MeshKey::Hash> chains;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include "MatrixOperations.h"
+
+/*
+Exact orientation of a cubie: one of the 24 rotations of a cube.
+Every finished turn is a table lookup, so no float error ever builds up, however many turns.
+The float model matrix is composed from it (plus the grid position and, for a turning layer,
+the in-flight quaternion, see TransformStore) instead of being multiplied frame after frame.
+*/
+
+// All 24 rotations as integer 3x3 matrices (row-major, entries -1/0/1)
+// and the result of a quarter turn around each axis. Built by the compiler (ORIENTATION_TABLES):
+// no startup work, and the static_asserts below check the group before the program even runs.
+class OrientationTables {
+public:
+    static const int COUNT = 24;
+    int count = 0;
+    int matrices[COUNT][9] = {};
+    // Same rotations as floats, column-major (matrix3 / affine layout), for composing model matrices
+    float columns[COUNT][9] = {};
+    // turn[o][axis][dir] = orientation after a +90 (dir 1) or -90 (dir 0) degree turn around axis
+    unsigned char turn[COUNT][3][2] = {};
+
+    constexpr OrientationTables() {
+        const int identity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+        Add(identity);
+        // Closure of the identity under quarter turns; new orientations are appended while we walk
+        for (int o = 0; o < count; ++o) {
+            for (int axis = 0; axis < 3; ++axis) {
+                for (int dir = 0; dir < 2; ++dir) {
+                    int q[9] = {}, result[9] = {};
+                    QuarterTurnMatrix(axis, dir == 1, q);
+                    Multiply(q, matrices[o], result);
+                    turn[o][axis][dir] = (unsigned char)Add(result);
+                }
+            }
+        }
+        for (int o = 0; o < count; ++o)
+            for (int row = 0; row < 3; ++row)
+                for (int col = 0; col < 3; ++col) columns[o][col * 3 + row] = (float)matrices[o][row * 3 + col];
+    }
+    // The plain quarter turn itself (= identity turned once), e.g. for moving grid positions
+    constexpr const int* QuarterTurn(int axis, int dir) const { return matrices[turn[0][axis][dir > 0 ? 1 : 0]]; }
+
+private:
+    // Entries are -1/0/1: one base-3 digit each, so a rotation is one int to compare
+    int keys[COUNT] = {};
+    static constexpr int Key(const int m[9]) {
+        int key = 0;
+        for (int k = 0; k < 9; ++k) key = key * 3 + (m[k] + 1);
+        return key;
+    }
+    constexpr int Add(const int m[9]) {
+        int key = Key(m);
+        for (int i = 0; i < count; ++i)
+            if (keys[i] == key) return i;
+        for (int k = 0; k < 9; ++k) matrices[count][k] = m[k];
+        keys[count] = key;
+        return count++;
+    }
+    // +/-90 degrees around X, Y or Z, right-handed like matrix4::RotateX/Y/Z
+    static constexpr void QuarterTurnMatrix(int axis, bool positive, int out[9]) {
+        int s = positive ? 1 : -1;
+        for (int k = 0; k < 9; ++k) out[k] = 0;
+        int a = axis, b = (axis + 1) % 3, c = (axis + 2) % 3;
+        out[a * 3 + a] = 1;
+        // b -> c, c -> -b (for X: y -> z, z -> -y)
+        out[c * 3 + b] = s;
+        out[b * 3 + c] = -s;
+    }
+    static constexpr void Multiply(const int a[9], const int b[9], int out[9]) {
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                out[r * 3 + c] = a[r * 3 + 0] * b[0 * 3 + c] + a[r * 3 + 1] * b[1 * 3 + c] + a[r * 3 + 2] * b[2 * 3 + c];
+    }
+};
+
+inline constexpr OrientationTables ORIENTATION_TABLES{};
+
+// Compile-time checks of the tables: the rotation group of the cube has 24 elements,
+// and four quarter turns around any axis bring every orientation back
+static_assert(ORIENTATION_TABLES.count == OrientationTables::COUNT, "a cube has 24 orientations");
+constexpr bool FourQuarterTurnsAreIdentity() {
+    for (int o = 0; o < OrientationTables::COUNT; ++o)
+        for (int axis = 0; axis < 3; ++axis)
+            for (int dir = 0; dir < 2; ++dir) {
+                int t = o;
+                for (int k = 0; k < 4; ++k) t = ORIENTATION_TABLES.turn[t][axis][dir];
+                if (t != o) return false;
+            }
+    return true;
+}
+static_assert(FourQuarterTurnsAreIdentity(), "quarter turn table is inconsistent");
+
+class Orientation {
+public:
+    unsigned char index = 0; // into ORIENTATION_TABLES, 0 = identity
+
+    // This orientation followed by a quarter turn around axis (0 X, 1 Y, 2 Z), dir > 0 = +90 degrees
+    constexpr Orientation Turned(int axis, int dir) const {
+        Orientation o;
+        o.index = ORIENTATION_TABLES.turn[index][axis][dir > 0 ? 1 : 0];
+        return o;
+    }
+    constexpr const int* Matrix() const { return ORIENTATION_TABLES.matrices[index]; }
+};
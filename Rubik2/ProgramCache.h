@@ -0,0 +1,131 @@
+#pragma once
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include "Mesh.h"
+#include "Hash.h"
+
+/*
+Cache of linked shader programs (glGetProgramBinary) so a launch can skip compiling and linking,
+which is slow with software GL. One file per program in shader_cache/, named after a hash of
+ - the vertex + fragment source
+ - GL vendor, renderer and version strings (a binary only loads on the driver that made it)
+The driver string is also stored in the file and checked again when loading.
+Anything that does not match or does not load (driver update, corrupt file) falls back
+to a normal compile, which then rewrites the entry.
+
+Set SHADER_CACHE=off in the environment to always compile (to compare startup times).
+Drivers without program binaries (no ARB_get_program_binary / no binary formats) just compile.
+*/
+
+class ProgramCache {
+public:
+    // Startup statistics, for PrintStats
+    static inline int loaded = 0;
+    static inline int compiled = 0;
+    static inline double totalMs = 0.0;
+
+    static bool Enabled() {
+        static const bool enabled = [] {
+            const char* env = std::getenv("SHADER_CACHE");
+            if (env && (std::string(env) == "off" || std::string(env) == "0")) return false;
+            if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri) return false;
+            int formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            return formats > 0;
+        }();
+        return enabled;
+    }
+
+    // Creates the program from the cache. Returns 0 when there is no usable entry.
+    static unsigned int Load(const std::string& vertexCode, const std::string& fragmentCode) {
+        if (!Enabled()) return 0;
+        std::ifstream file(PathFor(vertexCode, fragmentCode), std::ios::binary);
+        if (!file) return 0;
+        uint32_t magic = 0, format = 0, driverLength = 0, binaryLength = 0;
+        file.read((char*)&magic, sizeof(magic));
+        file.read((char*)&format, sizeof(format));
+        file.read((char*)&driverLength, sizeof(driverLength));
+        if (!file || magic != MAGIC || driverLength > 4096) return 0;
+        std::string driver(driverLength, '\0');
+        file.read(&driver[0], driverLength);
+        file.read((char*)&binaryLength, sizeof(binaryLength));
+        if (!file || driver != DriverString()) return 0;
+        std::vector<char> binary(binaryLength);
+        file.read(binary.data(), binaryLength);
+        if (!file) return 0;
+
+        unsigned int program = glCreateProgram();
+        glProgramBinary(program, (GLenum)format, binary.data(), (GLsizei)binaryLength);
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            // Driver refused it (it may reject binaries for any reason), compile instead
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    // Call on a fresh program before glLinkProgram, so the driver keeps the binary around
+    static void PrepareForLink(unsigned int program) {
+        if (Enabled()) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // Writes a freshly linked program to the cache
+    static void Store(const std::string& vertexCode, const std::string& fragmentCode, unsigned int program) {
+        if (!Enabled()) return;
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        std::error_code error;
+        std::filesystem::create_directories(DIRECTORY, error);
+        std::ofstream file(PathFor(vertexCode, fragmentCode), std::ios::binary);
+        if (!file) return;
+        const std::string driver = DriverString();
+        uint32_t magic = MAGIC, format32 = format, driverLength = (uint32_t)driver.size(), binaryLength = (uint32_t)length;
+        file.write((const char*)&magic, sizeof(magic));
+        file.write((const char*)&format32, sizeof(format32));
+        file.write((const char*)&driverLength, sizeof(driverLength));
+        file.write(driver.data(), driverLength);
+        file.write((const char*)&binaryLength, sizeof(binaryLength));
+        file.write(binary.data(), binaryLength);
+    }
+
+    static void PrintStats() {
+        std::cout << "Shaders ready in " << totalMs << " ms (" << loaded << " from cache, " << compiled << " compiled"
+                  << (Enabled() ? "" : ", cache off") << ")\n";
+    }
+
+private:
+    static constexpr const char* DIRECTORY = "shader_cache";
+    static constexpr uint32_t MAGIC = 0x42505347; // "GSPB"
+
+    static std::string DriverString() {
+        auto str = [](GLenum name) {
+            const unsigned char* s = glGetString(name);
+            return s ? std::string((const char*)s) : std::string();
+        };
+        return str(GL_VENDOR) + "|" + str(GL_RENDERER) + "|" + str(GL_VERSION);
+    }
+    static uint64_t Hash(const std::string& data, uint64_t seed = FNV1A_OFFSET_BASIS) {
+        return Fnv1a(data.data(), data.size(), seed);
+    }
+    static std::string PathFor(const std::string& vertexCode, const std::string& fragmentCode) {
+        uint64_t hash = Hash(vertexCode);
+        hash = Hash(std::string(1, '\0') + fragmentCode, hash);
+        hash = Hash(DriverString(), hash);
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+        return std::string(DIRECTORY) + "/" + name;
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include "Mesh.h" // glad + GLFW
+
+/*
+Decides when the main loop draws a frame.
+While something moves (animation, playback) frames run back to back, just like before.
+When nothing moves the loop sleeps in glfwWaitEventsTimeout until:
+ - an input / window event arrives (the callbacks call RequestRedraw)
+ - a wake-up time registered with WakeAt is reached (gravity tick...)
+ - MAX_IDLE_WAIT runs out (only counted, no frame is drawn)
+An idle window then costs a couple of wake-ups per second instead of a full frame rate.
+
+Typical loop:
+    scheduler.SetAnimating(...);
+    scheduler.WaitForWork();
+    if (!scheduler.ShouldRender()) continue;
+    float dt = scheduler.BeginFrame();
+    ... draw, swap ...
+    scheduler.EndFrame();
+*/
+
+class RenderScheduler {
+public:
+    const double MAX_IDLE_WAIT = 0.5; // seconds, longest single sleep
+
+    // Counters, to check that an idle window really is idle
+    unsigned long long framesRendered = 0; // frames actually drawn
+    unsigned long long loopIterations = 0; // WaitForWork calls
+    unsigned long long idleWaits = 0;      // times the loop went to sleep
+
+    // Something changed, draw the next frame
+    void RequestRedraw() { redrawRequested = true; }
+    // Keep drawing every frame while true (animations)
+    void SetAnimating(bool value) { animating = value; }
+    // Wake up at this glfwGetTime() time even without events. Holds for one WaitForWork.
+    void WakeAt(double time) { wakeTime = std::min(wakeTime, time); }
+
+    // Process events, sleeping first if there is nothing to draw
+    void WaitForWork() {
+        ++loopIterations;
+        if (animating || redrawRequested) {
+            glfwPollEvents();
+        } else {
+            double timeout = std::min(MAX_IDLE_WAIT, wakeTime - glfwGetTime());
+            if (timeout > 0.0) {
+                glfwWaitEventsTimeout(timeout);
+                ++idleWaits;
+                wasIdle = true;
+            } else {
+                glfwPollEvents();
+            }
+        }
+        wakeTime = NO_WAKE;
+    }
+    bool ShouldRender() const { return animating || redrawRequested; }
+
+    // Seconds since the last drawn frame. 0 for the first frame after a sleep,
+    // nothing was moving then, so the time spent sleeping must not jump an animation forward.
+    float BeginFrame() {
+        double now = glfwGetTime();
+        float dt = (wasIdle || lastFrameTime < 0.0) ? 0.0f : (float)(now - lastFrameTime);
+        lastFrameTime = now;
+        wasIdle = false;
+        redrawRequested = false; // requests made while drawing count for the next frame
+        return dt;
+    }
+    void EndFrame() { ++framesRendered; }
+
+    void PrintStats(std::ostream& out = std::cout) const {
+        double seconds = glfwGetTime();
+        out << "Render stats: " << framesRendered << " frames, " << loopIterations << " loop iterations, "
+            << idleWaits << " idle waits in " << seconds << " s";
+        if (seconds > 0.0) out << " (" << framesRendered / seconds << " fps average)";
+        out << "\n";
+    }
+
+private:
+    static constexpr double NO_WAKE = 1e30;
+    bool redrawRequested = true; // first frame
+    bool animating = false;
+    bool wasIdle = false;
+    double wakeTime = NO_WAKE;
+    double lastFrameTime = -1.0;
+};
@@ -3,10 +3,16 @@
 #include <map>
 #include <cmath>
 #include "Shader.h"
+#include "StickerRenderer.h"
+#include "CubieRenderer.h"
+#include "Orientation.h"
+#include "TransformStore.h"
 //For random movements(and solver movements, possibly)
 #include <queue>
 #include <random>
 #include <string>
+#include <algorithm>
+#include <chrono>
 
 // Map cube face letters to ANSI color codes
 std::string GetColor(char c) {
@@ -38,6 +44,12 @@ const UVRange UV_GREEN  = {3.0f * U_SIZE, V_SIZE, 4.0f * U_SIZE, 2.0f * V_SIZE};
 const UVRange UV_WHITE  = {U_SIZE, 2.0f * V_SIZE, 2.0f * U_SIZE, 3.0f * V_SIZE}; // (1, 0) -> Top
 const UVRange UV_YELLOW = {U_SIZE, 0.0f, 2.0f * U_SIZE, V_SIZE};                // (1, 2) -> Bottom
 
+// Sticker palette for the instanced sticker renderer (index = color)
+enum StickerColor { COLOR_BLACK, COLOR_WHITE, COLOR_YELLOW, COLOR_GREEN, COLOR_BLUE, COLOR_ORANGE, COLOR_RED };
+const std::vector<UVRange> STICKER_PALETTE = { UV_BLACK, UV_WHITE, UV_YELLOW, UV_GREEN, UV_BLUE, UV_ORANGE, UV_RED };
+// From this size on only the stickers are drawn (instanced), not whole cubies
+const int STICKER_RENDER_MIN_SIZE = 6;
+
 const float CUBIE_GAP = 0.05f; //small distance between cubes(cubies), so they do not overlap.
 const float CUBIE_OFFSET = 1.0f + CUBIE_GAP;
 // Colors list
@@ -46,20 +58,23 @@ const float CUBIE_OFFSET = 1.0f + CUBIE_GAP;
 
 class Cubie {
 	public:
-    int gridPos[3]; 
-    matrix4 modelMatrix;
+    int gridPos[3]; // layer index on each axis, 0..N-1
+    int sliceSlot[3]; // where this cubie sits inside RubikCube's slice lists (one per axis)
+    unsigned int faceColors = 0; // StickerColor of each face, packed 3 bits per face (PackFaceColors)
+    Orientation orientation;     // exact, one of 24
+    int transform = -1;          // handle into RubikCube::transforms (model composed from gridPos + orientation)
     //std::map<vec3, FaceColor> faceColors; 
-	Mesh mesh;
 	
-    Cubie(int x, int y, int z, const Mesh& cubieMeshInstance): mesh(cubieMeshInstance) {
+    // No geometry of its own, the shared cube (or the stickers) is drawn instanced
+    Cubie(int x, int y, int z) {
         gridPos[0] = x; gridPos[1] = y; gridPos[2] = z;
-        modelMatrix = mesh.modelMatrix;
     }
-    // pivot position (center of the cube)
-    vec3 getCenter() const {
-        return vec3(gridPos[0] * CUBIE_OFFSET,
-                    gridPos[1] * CUBIE_OFFSET,
-                    gridPos[2] * CUBIE_OFFSET);
+    // pivot position (center of the cube), for a cube of n layers centered at (0, 0, 0)
+    vec3 getCenter(int n) const {
+        float half = (n - 1) * 0.5f;
+        return vec3((gridPos[0] - half) * CUBIE_OFFSET,
+                    (gridPos[1] - half) * CUBIE_OFFSET,
+                    (gridPos[2] - half) * CUBIE_OFFSET);
     }
 };
 enum class Axis { X, Y, Z };
@@ -76,11 +91,32 @@ public:
     int layer;
     int direction;
 };
+class LayerRotation {
+/*
+Animation state of ONE layer that is currently turning.
+Turns on the same axis but different layers commute (R L', U D, ...),
+so the scheduler can keep several of these in flight and animate them in the same frames.
+*/
+public:
+    Axis axis;
+    int layer;
+    float direction;
+    float currentAngle = 0.0f;
+    float targetAngle = 0.0f; // +/- 90 degrees (PI/2)
+};
 
 class RubikCube {
 private:
-    // The 3x3x3 grid of cubies
+    // Cube size, N x N x N. Layers on every axis go from 0 to N-1.
+    int N = 3;
+    // Only the visible (surface) cubies, N^3 - (N-2)^3 of them
     std::vector<Cubie> cubies;
+    // Their positions, rotations and model matrices, contiguous (SoA), indexed by Cubie::transform.
+    // Never accumulated: composed from the exact orientation and grid center (+ the turn in flight).
+    TransformStore transforms;
+    // Slice index: slices[axis][layer] lists the cubies currently in that layer,
+    // so a layer turn only touches its own pieces instead of scanning every cubie.
+    std::vector<std::vector<int>> slices[3];
 	//Rubik State Tracker - Kociemba style - Solved/Initial Cube String.
 	std::string RubikState = "UUUUUUUUURRRRRRRRRFFFFFFFFFDDDDDDDDDLLLLLLLLLBBBBBBBBB"; 
 	std::string MoveList;
@@ -89,54 +125,108 @@ private:
 	std::queue<std::string> moveQueue;
     //Rubik's Cube center
     vec3 cubeCenter = vec3(0.0f, 0.0f, 0.0f);
+	// Big cubes: stickers only, one instanced draw
+	bool useStickerRenderer = false;
+	StickerRenderer stickerRenderer;
+	// Normal cubes: one instance per cubie, one instanced draw
+	CubieRenderer cubieRenderer;
 	// Outline Drawing
 	bool isSliceSelected = false;
     Axis selectedAxis = Axis::X; 
-    int selectedLayer = 1;
+    int selectedLayer = 2;
 	// Animation State & Rotation Variables
-    float currentRotationAngle = 0.0f;
-    float targetRotationAngle = 0.0f; // +/- 90 degrees (PI/2) - Need more? Call RotateAgain.
+	// One entry per turning layer. Commuting moves share the same frames.
+	std::vector<LayerRotation> activeRotations;
 	const float ANIMATION_DURATION = 0.25f; // Target time in seconds
     const float ROTATION_SPEED = (PI / 2.0f) / ANIMATION_DURATION;
+	// Playback of long move queues
+	const size_t TURBO_QUEUE_THRESHOLD = 24;  // more queued moves than this -> snap instead of animate
+	const float TURBO_FRAME_BUDGET = 0.004f;  // seconds per frame we may spend snapping moves
+	const float ADAPTIVE_QUEUE_STEP = 8.0f;   // +1x animation speed for every 8 queued moves
+	const float MAX_PLAYBACK_SPEEDUP = 4.0f;
 public:
 	//bool isScrambling = false;
 	bool isRotating = false; //Prevent new rotations while one is in progress
 	bool executingSolution = false;
+	bool turboPlayback = true; // snap several moves per frame when the queue is long
 	float direction = 1.0f; // plus or minus
-	RubikCube() {
+	RubikCube(int n = 3) : N(std::max(n, 1)) {
+        useStickerRenderer = (N >= STICKER_RENDER_MIN_SIZE);
+        if (useStickerRenderer) stickerRenderer.Setup();
+        else cubieRenderer.Setup();
         InitializeCubies();
 		std::cout << "Cube State: " << GetState() << "\n";
     }
-	// Iterate through X, Y, Z centered at (0, 0, 0)
+	// Iterate through X, Y, Z. Layer i sits at (i - (N-1)/2) * CUBIE_OFFSET, so the cube is centered at (0, 0, 0)
     void InitializeCubies() {
-        for (int x = -1; x <= 1; ++x) {
-            for (int y = -1; y <= 1; ++y) {
-                for (int z = -1; z <= 1; ++z) {
-                    if (x == 0 && y == 0 && z == 0) continue; // Skip center
-					// Define the UV ranges for this cubie based on its position
-					UVRange front = (z == 1) ? UV_GREEN : UV_BLACK;
-					UVRange back  = (z == -1) ? UV_BLUE : UV_BLACK;
-					UVRange left  = (x == -1) ? UV_ORANGE : UV_BLACK;
-					UVRange right = (x == 1) ? UV_RED : UV_BLACK;
-					UVRange bottom = (y == -1) ? UV_YELLOW : UV_BLACK;
-					UVRange top   = (y == 1) ? UV_WHITE : UV_BLACK;
-					// Cubie instance
-					Mesh cubieMeshInstance = CreateRubikCubieMesh(
-						front, back, left, right, bottom, top,
-						x * CUBIE_OFFSET, y * CUBIE_OFFSET, z * CUBIE_OFFSET
-					);
-                    
-					Cubie newCubie(x, y, z, cubieMeshInstance);
-					newCubie.modelMatrix.Translate(x * CUBIE_OFFSET, y * CUBIE_OFFSET, z * CUBIE_OFFSET);
-                    cubies.push_back(std::move(newCubie));
+        cubies.clear();
+        transforms.Clear();
+        stickerRenderer.Clear();
+        for (int a = 0; a < 3; ++a) slices[a].assign(N, std::vector<int>());
+        int last = N - 1;
+        float half = last * 0.5f;
+        for (int x = 0; x < N; ++x) {
+            for (int y = 0; y < N; ++y) {
+                // Hidden interior cubies are never stored. Inside the core only z = 0 and z = N-1 are visible.
+                bool innerXY = (x > 0 && x < last && y > 0 && y < last);
+                int zStep = (innerXY && last > 0) ? last : 1;
+                for (int z = 0; z < N; z += zStep) {
+					float px = (x - half) * CUBIE_OFFSET;
+					float py = (y - half) * CUBIE_OFFSET;
+					float pz = (z - half) * CUBIE_OFFSET;
+					int colors[6];
+					colors[FACE_FRONT]  = (z == last) ? COLOR_GREEN : COLOR_BLACK;
+					colors[FACE_BACK]   = (z == 0) ? COLOR_BLUE : COLOR_BLACK;
+					colors[FACE_LEFT]   = (x == 0) ? COLOR_ORANGE : COLOR_BLACK;
+					colors[FACE_RIGHT]  = (x == last) ? COLOR_RED : COLOR_BLACK;
+					colors[FACE_BOTTOM] = (y == 0) ? COLOR_YELLOW : COLOR_BLACK;
+					colors[FACE_TOP]    = (y == last) ? COLOR_WHITE : COLOR_BLACK;
+					// Plain data, no GL allocation per cubie
+					Cubie newCubie(x, y, z);
+					newCubie.faceColors = PackFaceColors(colors);
+					newCubie.transform = transforms.Create(vec3(px, py, pz));
+                    cubies.push_back(newCubie);
+                    int id = (int)cubies.size() - 1;
+                    for (int a = 0; a < 3; ++a) AddToSlice(a, id);
+					if (useStickerRenderer) {
+						for (int f = 0; f < 6; ++f) {
+							if (colors[f] != COLOR_BLACK) stickerRenderer.AddSticker(id, (CubieFace)f, colors[f]);
+						}
+					}
                 }
             }
         }
-		
-	//	for (auto& c : cubies) {
-    //std::cout << "Cubie (" << c.mesh.center.x << ", " << c.mesh.center.y << ", " << c.mesh.center.z << ")\n";}
-		
+        cubieRenderer.dirty = true;
     }
+	int GetSize() const { return N; }
+	bool UsesStickerRenderer() const { return useStickerRenderer; }
+	size_t GetCubieCount() const { return cubies.size(); }
+	// --- Slice index ---
+	void AddToSlice(int axisIndex, int id) {
+		std::vector<int>& slice = slices[axisIndex][cubies[id].gridPos[axisIndex]];
+		cubies[id].sliceSlot[axisIndex] = (int)slice.size();
+		slice.push_back(id);
+	}
+	// Swap-remove, O(1). The cubie moved into the hole gets its slot fixed.
+	void RemoveFromSlice(int axisIndex, int id) {
+		std::vector<int>& slice = slices[axisIndex][cubies[id].gridPos[axisIndex]];
+		int slot = cubies[id].sliceSlot[axisIndex];
+		int moved = slice.back();
+		slice[slot] = moved;
+		cubies[moved].sliceSlot[axisIndex] = slot;
+		slice.pop_back();
+	}
+	// Quarter turn of one grid position around the cube center, exact integer math:
+	// the compile-time quarter-turn matrix applied to the doubled, centered position (2 * pos - last).
+	// dir > 0 is +90 degrees (same sense as matrix4::RotateX/Y/Z).
+	void RotateGridPos(int pos[3], Axis axis, int dir) const {
+		int axisIndex = (axis == Axis::X) ? 0 : (axis == Axis::Y) ? 1 : 2;
+		const int* q = ORIENTATION_TABLES.QuarterTurn(axisIndex, dir);
+		int last = N - 1;
+		int c[3] = { 2 * pos[0] - last, 2 * pos[1] - last, 2 * pos[2] - last };
+		for (int row = 0; row < 3; ++row)
+			pos[row] = (q[row * 3] * c[0] + q[row * 3 + 1] * c[1] + q[row * 3 + 2] * c[2] + last) / 2;
+	}
 	// --- State Tracker Logic ---
 	std::string GetState()
 	{
@@ -264,10 +354,10 @@ public:
 	}
 
 	
-	std::string getMoveString(Axis axis, int layer, float direction) {
+	std::string getMoveString(Axis axis, int layer, int direction) {
 		//After a movement, return the movement type(F, R, B, etc)
-		//Center(layer 0) is a Special Case(Equals two movements)
-		if (layer == 0) {
+		//Center(the middle layer of a 3x3) is a Special Case(Equals two movements)
+		if (N == 3 && layer == 1) {
 			// Return a special marker for decomposition in FinalizeSliceRotation
 			if (axis == Axis::X && direction < 0) return "M"; //Middle Slice      - X axis
 			if (axis == Axis::X && direction > 0) return "M'";
@@ -276,20 +366,27 @@ public:
 			if (axis == Axis::Z && direction < 0) return "S"; //Equator Slice     - Z axis
 			if (axis == Axis::Z && direction > 0) return "S'";
 		}
-		// FACE moves (layer = -1 or 1)
+		// FACE moves (layer = 0 or N-1)
 		std::string face = "";
-		int layer_abs = std::abs(layer);
-		if (axis == Axis::X) { // X-axis: Right (Layer 1) or Left (Layer -1)
-			face = (layer == 1) ? "R" : "L";
-		} else if (axis == Axis::Y) { // Y-axis: Up (Layer 1) or Down (Layer -1)
-			face = (layer == 1) ? "U" : "D";
-		} else if (axis == Axis::Z) { // Z-axis: Front (Layer 1) or Back (Layer -1)
-			face = (layer == 1) ? "F" : "B";
-		}
+		int last = N - 1;
+		// Inner layers of bigger cubes use slice notation: "3R" is the third layer counted from R
+		std::string prefix = "";
+		if (layer != 0 && layer != last) {
+			prefix = std::to_string(last - layer + 1);
+			layer = last;
+		}
+		if (axis == Axis::X) { // X-axis: Right (Layer N-1) or Left (Layer 0)
+			face = (layer == last) ? "R" : "L";
+		} else if (axis == Axis::Y) { // Y-axis: Up (Layer N-1) or Down (Layer 0)
+			face = (layer == last) ? "U" : "D";
+		} else if (axis == Axis::Z) { // Z-axis: Front (Layer N-1) or Back (Layer 0)
+			face = (layer == last) ? "F" : "B";
+		}
+		face = prefix + face;
 		// For 90 degree turns (clockwise or counter-clockwise)
 		// R, U, F, D, L, B notation is defined as a Clockwise turn when looking at the face.
 		// L and B faces are opposite the positive axes, clockwise becomes counter-intuitive.
-		if (face == "R" || face == "U" || face == "F") {
+		if (layer == last) {
 			// Positive faces (R, U, F): Clockwise is Positive Direction (+1.0f)
 			if (direction > 0) return face;   
 			else return face + "'";           
@@ -311,56 +408,110 @@ public:
         isSliceSelected = true;
         selectedAxis = axis;
         selectedLayer = layer;
+        MarkInstancesDirty();
     }
     void DeselectSlice() {
         isSliceSelected = false;
+        MarkInstancesDirty();
     }
     // Rotates the slice dependent on the axis and selected layer
+	// Layers turning or a solution still playing, the window must keep drawing
+	bool IsAnimating() const { return isRotating || executingSolution; }
 	void RotateSlice(Axis axis, int layer) {
 		if (isRotating) return;
-		isRotating = true;
-		currentRotationAngle = 0.0f;
-		selectedAxis = axis; //rotationAxis
-		selectedLayer = layer;
+		BeginLayerRotation(axis, layer, direction);
+	}
+	// Queue a 90 degree turn of one layer. Does NOT check isRotating,
+	// the playback scheduler uses it to start several commuting layers at once.
+	void BeginLayerRotation(Axis axis, int layer, float dir) {
+		LayerRotation rot;
+		rot.axis = axis;
+		rot.layer = layer;
+		rot.direction = dir;
+		rot.currentAngle = 0.0f;
 		// Target is always 90 degrees in the specified direction (+/- PI/2)
-		targetRotationAngle = direction * (PI / 2.0f); 	
+		rot.targetAngle = dir * (PI / 2.0f);
+		activeRotations.push_back(rot);
+		isRotating = true;
 	}
 	//Snap Rotation - Rotate without animation.
-    void RotateSliceSnap(Axis axis, int layer, float angleRadians = 90.0f) {
-		//Should not rotate unless we are allowed to select a slice.
-		//At least not manually...
-			if(isSliceSelected = false) return; 
-        matrix4 rotationMat; 
-        switch (axis) {
-            case Axis::X: rotationMat.RotateX(angleRadians*direction); break;
-            case Axis::Y: rotationMat.RotateY(angleRadians*direction); break;
-            case Axis::Z: rotationMat.RotateZ(angleRadians*direction); break;
-        }
-		
-        int axisIndex = (axis == Axis::X) ? 0 : (axis == Axis::Y) ? 1 : 2;
-        // Find and rotate all 9 cubies
-        for (auto& cubie : cubies) {
-            if (cubie.gridPos[axisIndex] == layer) {
-                cubie.modelMatrix = rotationMat * cubie.modelMatrix;
-            }
-        }
-		
-		//Update GRID  of CUBIES
-		FinalizeSliceRotation(selectedAxis, selectedLayer, direction);
+    void RotateSliceSnap(Axis axis, int layer, float angleRadians = PI / 2.0f) {
+		if (isRotating) return;
+		SnapLayerRotation(axis, layer, angleRadians * direction);
     }
+	// Turn one layer by a full quarter turn in one go and update the tracker.
+	// angle is +/- PI/2, the sign gives the direction.
+	void SnapLayerRotation(Axis axis, int layer, float angle) {
+		//Update GRID  of CUBIES (and their orientation + model matrix)
+		FinalizeSliceRotation(axis, layer, angle);
+	}
+	// Turbo playback: snap queued moves until the frame budget is used up
+	// (or the queue is short enough to animate again). The caller still
+	// renders after this, so every frame shows an intermediate state.
+	int SnapQueuedMoves() {
+		auto frameStart = std::chrono::steady_clock::now();
+		int snapped = 0;
+		Move move;
+		while (moveQueue.size() > TURBO_QUEUE_THRESHOLD) {
+			if (ParseMove(moveQueue.front(), move)) {
+				SnapLayerRotation(move.axis, move.layer, move.direction * (PI / 2.0f));
+				++snapped;
+			} else {
+				std::cout << "--------------- INVALID MOVE: " << moveQueue.front() << " --------------- \n";
+			}
+			moveQueue.pop();
+			std::chrono::duration<float> spent = std::chrono::steady_clock::now() - frameStart;
+			if (spent.count() >= TURBO_FRAME_BUDGET) break;
+		}
+		return snapped;
+	}
+	// Animation speed multiplier for solution playback.
+	// Short queues play at the normal pace, long ones speed up linearly.
+	float PlaybackSpeedScale() const {
+		if (!executingSolution) return 1.0f;
+		float scale = 1.0f + (float)moveQueue.size() / ADAPTIVE_QUEUE_STEP;
+		return std::min(scale, MAX_PLAYBACK_SPEEDUP);
+	}
+	// Pop the next move and every following move that commutes with it
+	// (same axis, a layer not already turning) and start them together.
+	// "R L' R" -> [R L'] then [R]; "U D U'" -> [U D] then [U'].
+	void StartNextMoveGroup() {
+		Move first;
+		while (!moveQueue.empty() && !ParseMove(moveQueue.front(), first)) {
+			std::cout << "--------------- INVALID MOVE: " << moveQueue.front() << " --------------- \n";
+			moveQueue.pop();
+		}
+		if (moveQueue.empty()) return;
+		moveQueue.pop();
+		BeginLayerRotation(first.axis, first.layer, (float)first.direction);
+
+		Move next;
+		while (!moveQueue.empty() && ParseMove(moveQueue.front(), next)) {
+			if (next.axis != first.axis) break;
+			bool layerBusy = false;
+			for (const auto& rot : activeRotations) {
+				if (rot.layer == next.layer) { layerBusy = true; break; }
+			}
+			if (layerBusy) break; // R R is not a commuting pair, play it in order
+			moveQueue.pop();
+			BeginLayerRotation(next.axis, next.layer, (float)next.direction);
+		}
+	}
     
 	// In RubikCube.h, inside the RubikCube class
 	void Update(float dt) {
 		
 		if (executingSolution && !isRotating)
 		{
+			if (turboPlayback && moveQueue.size() > TURBO_QUEUE_THRESHOLD)
+			{
+				// Way too many moves left to animate them one by one
+				SnapQueuedMoves();
+				return;
+			}
 			if (!moveQueue.empty())
 			{
-				std::string nextMove = moveQueue.front();
-				moveQueue.pop();
-
-				AdjustRotationValues(nextMove);
-				//std::cout << "Executing move: " << nextMove << "\n";
+				StartNextMoveGroup();
 			}
 			else
 			{
@@ -373,134 +524,84 @@ public:
 		
 		
 		if (!isRotating) return;
-		float rotationAmount = ROTATION_SPEED * dt;
-		// Clockwise or Counter-clockwise?
-		float sign = (targetRotationAngle > 0) ? 1.0f : -1.0f;
-		// Don't go over the target angle
-		// If we do, then SNAP the remaining rotation and STOP
-		if (std::abs(currentRotationAngle) + rotationAmount >= std::abs(targetRotationAngle)) {
-			rotationAmount = std::abs(targetRotationAngle) - std::abs(currentRotationAngle);
-			isRotating = false;
-			// FOR THE SOLVER - UPDATE THE TRACKER POSITION
-			FinalizeSliceRotation(selectedAxis, selectedLayer, direction);
-		}
-		ApplyFrameRotation(selectedAxis, selectedLayer, rotationAmount * sign);
-		currentRotationAngle += rotationAmount;
-	}
-	void ApplyFrameRotation(Axis axis, int layer, float angle) {
-		matrix4 rotationMat;
-		switch (axis) {
-			case Axis::X: rotationMat.RotateX(angle); break;
-			case Axis::Y: rotationMat.RotateY(angle); break;
-			case Axis::Z: rotationMat.RotateZ(angle); break;
-		}
-		int axisIndex = (axis == Axis::X) ? 0 : (axis == Axis::Y) ? 1 : 2;
-		// Apply small rotation to the model matrix
-		for (auto& cubie : cubies) {
-			if (cubie.gridPos[axisIndex] == layer) {
-				cubie.modelMatrix = rotationMat * cubie.modelMatrix;
+		float frameAmount = ROTATION_SPEED * PlaybackSpeedScale() * dt;
+		// Every active layer turns by the same amount, so a commuting group
+		// finishes in the same frame as a single move would.
+		for (auto& rot : activeRotations) {
+			float rotationAmount = frameAmount;
+			// Clockwise or Counter-clockwise?
+			float sign = (rot.targetAngle > 0) ? 1.0f : -1.0f;
+			// Don't go over the target angle
+			// If we do, then SNAP the remaining rotation and STOP
+			bool finished = false;
+			if (std::abs(rot.currentAngle) + rotationAmount >= std::abs(rot.targetAngle)) {
+				rotationAmount = std::abs(rot.targetAngle) - std::abs(rot.currentAngle);
+				finished = true;
+			}
+			rot.currentAngle += rotationAmount * sign;
+			if (finished) {
+				rot.currentAngle = rot.targetAngle; // exact, for the cleanup below
+				// FOR THE SOLVER - UPDATE THE TRACKER POSITION
+				// (only changes the coordinates off the rotation axis, so the
+				// other layers of the group still find their cubies).
+				// Also lands the layer on its exact new orientation, whatever the frame steps were.
+				FinalizeSliceRotation(rot.axis, rot.layer, rot.direction);
+			} else {
+				ComposeTurningLayer(rot.axis, rot.layer, rot.currentAngle);
 			}
 		}
+		activeRotations.erase(
+			std::remove_if(activeRotations.begin(), activeRotations.end(),
+				[](const LayerRotation& rot) { return std::abs(rot.currentAngle) >= std::abs(rot.targetAngle); }),
+			activeRotations.end());
+		isRotating = !activeRotations.empty();
 	}
-	// Update the internal gridPos after a full 90-degree 
-
-	// (We will only update the gridPos here, not the modelMatrix, since this is a 
-	// state-tracking helper, not an animation function.)
-	void ApplyWholeCubeRotation(Axis axis, float direction) {
-		for (auto& cubie : cubies) {
-			int oldX = cubie.gridPos[0];
-			int oldY = cubie.gridPos[1];
-			int oldZ = cubie.gridPos[2];
-
-			switch (axis) {
-				case Axis::X: // Rotation around X (x or x')
-					if (direction > 0) { // x (+90 deg)
-						cubie.gridPos[1] = -oldZ;
-						cubie.gridPos[2] = oldY;
-					} else { // x' (-90 deg)
-						cubie.gridPos[1] = oldZ;
-						cubie.gridPos[2] = -oldY;
-					}
-					break;
-				case Axis::Y: // Rotation around Y (y or y')
-					if (direction > 0) { // y (+90 deg)
-						cubie.gridPos[0] = oldZ;
-						cubie.gridPos[2] = -oldX;
-					} else { // y' (-90 deg)
-						cubie.gridPos[0] = -oldZ;
-						cubie.gridPos[2] = oldX;
-					}
-					break;
-				case Axis::Z: // Rotation around Z (z or z')
-					if (direction > 0) { // z (+90 deg)
-						cubie.gridPos[0] = -oldY;
-						cubie.gridPos[1] = oldX;
-					} else { // z' (-90 deg)
-						cubie.gridPos[0] = oldY;
-						cubie.gridPos[1] = -oldX;
-					}
-					break;
-			}
+	// Model matrices of one layer that is angle radians into its turn: the turn as a quaternion (one matrix
+	// for the layer), times each cubie's exact resting pose. Only the N^2 (or 4N-4) cubies of that layer.
+	void ComposeTurningLayer(Axis axis, int layer, float angle) {
+		int axisIndex = (axis == Axis::X) ? 0 : (axis == Axis::Y) ? 1 : 2;
+		vec3 axisVector(axisIndex == 0 ? 1.0f : 0.0f, axisIndex == 1 ? 1.0f : 0.0f, axisIndex == 2 ? 1.0f : 0.0f);
+		affine turn(quat::AxisAngle(axisVector, angle).ToMatrix4());
+		for (int id : slices[axisIndex][layer]) {
+			transforms.ComposeTurning(cubies[id].transform, turn);
 		}
+		MarkInstancesDirty();
 	}
-	
 	// In RubikCube.h, inside the RubikCube class
 void FinalizeSliceRotation(Axis axis, int layer, float fullAngle) {
     int axisIndex = (axis == Axis::X) ? 0 : (axis == Axis::Y) ? 1 : 2;
-    for (auto& cubie : cubies) {
-        if (cubie.gridPos[axisIndex] == layer) {
-            //Update Layer assignment (This logic for 9 cubies is CORRECT and is kept)
-            int oldX = cubie.gridPos[0];
-            int oldY = cubie.gridPos[1];
-            int oldZ = cubie.gridPos[2];
-            switch (axis) {
-                case Axis::X:
-                    if (fullAngle > 0) {
-                        cubie.gridPos[1] = -oldZ;
-                        cubie.gridPos[2] = oldY;
-                    } else {
-                        cubie.gridPos[1] = oldZ;
-                        cubie.gridPos[2] = -oldY;
-                    }
-                    break;
-                case Axis::Y:
-                    if (fullAngle > 0) {
-                        cubie.gridPos[0] = oldZ;
-                        cubie.gridPos[2] = -oldX;
-                    } else {
-                        cubie.gridPos[0] = -oldZ;
-                        cubie.gridPos[2] = oldX;
-                    }
-                    break;
-                case Axis::Z:
-                    if (fullAngle > 0) {
-                        cubie.gridPos[0] = -oldY;
-                        cubie.gridPos[1] = oldX;
-                    } else {
-                        cubie.gridPos[0] = oldY;
-                        cubie.gridPos[1] = -oldX;
-                    }
-                    break;
-            }
-            
-        }
+    int dir = fullAngle > 0 ? 1 : -1; // +/-PI/2 or +/-1, only the sign is used from here on
+    int otherA = (axisIndex + 1) % 3;
+    int otherB = (axisIndex + 2) % 3;
+    // The turning layer keeps its members, they only move between the slices of the other two axes
+    for (int id : slices[axisIndex][layer]) {
+        RemoveFromSlice(otherA, id);
+        RemoveFromSlice(otherB, id);
+        //Update Layer assignment
+        RotateGridPos(cubies[id].gridPos, axis, dir);
+        AddToSlice(otherA, id);
+        AddToSlice(otherB, id);
+        // Exact resting pose: new orientation by table lookup, matrix rebuilt from scratch
+        cubies[id].orientation = cubies[id].orientation.Turned(axisIndex, dir);
+        int handle = cubies[id].transform;
+        transforms.SetRotation(handle, ORIENTATION_TABLES.columns[cubies[id].orientation.index]);
+        transforms.SetPosition(handle, cubies[id].getCenter(N));
+        transforms.Compose(handle);
     }
+    MarkInstancesDirty();
 
     // Update RubikState string
-    std::string move = getMoveString(axis, layer, fullAngle);
-    std::cout << "MoveMark " << move << std::endl;
+    std::string move = getMoveString(axis, layer, dir);
     
     // Decompose M, S, E into Outer Moves (R, L, U, D, F, B) + Whole Cube (x, y, z)
     // NOTE: This assumes your external script/pycuber handles 'x', 'y', 'z' in the input scramble string.
     if (move == "M") {
         // M (Clockwise, -90 deg X-axis) is R L' x'
         MoveList += "R L' x' ";
-		std::cout << "M - ";
     }
     else if(move == "M'") {
         // M' (Counter-Clockwise, +90 deg X-axis) is R' L x
         MoveList += "R' L x ";
-		std::cout << "M' - ";
     }
     // E: Y-Axis rotation (Between U/D faces).
 		else if(move == "E") {
@@ -528,91 +629,90 @@ void FinalizeSliceRotation(Axis axis, int layer, float fullAngle) {
 }
 
 	// --- State and Rendering ---
-	void Draw(const Shader& shader) {
-		for (const auto& cubie : cubies) {
-			bool isCubieSelected = false;
-			if (isSliceSelected) {
-				int axisIndex = (selectedAxis == Axis::X) ? 0 : (selectedAxis == Axis::Y) ? 1 : 2;
-				if (cubie.gridPos[axisIndex] == selectedLayer) {
-					isCubieSelected = true;
-				}
-			}
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-			glLineWidth(1.0f);
-			shader.setMat4("model", cubie.modelMatrix);
-			shader.setInt("mode", 0);
-			glBindVertexArray(cubie.mesh.VAO); 
-			glDrawElements(GL_TRIANGLES, cubie.mesh.indices.size(), GL_UNSIGNED_INT, 0);
-
-			//  Draw Outline
-			if (isCubieSelected) {
-				glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-				glLineWidth(5.0f); 
-				shader.setInt("mode", 1);
-				
-				glDrawElements(GL_TRIANGLES, cubie.mesh.indices.size(), GL_UNSIGNED_INT, 0);
-			}
-		}
-		//glBindVertexArray(0);
+	// The whole cube in one instanced draw call: cubies, or only the stickers for big cubes.
+	// Instances outside the frustum are left out.
+	void Draw(const Shader& shader, const Frustum& frustum) {
+		if (useStickerRenderer) DrawStickers(shader, frustum);
+		else DrawInstanced(shader, frustum);
+	}
+	// Model matrices or selection changed, instance buffers must be rebuilt
+	void MarkInstancesDirty() {
+		stickerRenderer.dirty = true;
+		cubieRenderer.dirty = true;
+	}
+	bool IsCubieSelected(int id) const {
+		int axisIndex = (selectedAxis == Axis::X) ? 0 : (selectedAxis == Axis::Y) ? 1 : 2;
+		return isSliceSelected && cubies[id].gridPos[axisIndex] == selectedLayer;
+	}
+	// Normal cubes: all cubies in one instanced draw call.
+	// The instance buffer is only rebuilt when a layer moved or the selection changed.
+	void DrawInstanced(const Shader& shader, const Frustum& frustum) {
+		if (cubieRenderer.dirty) {
+			cubieRenderer.UpdateInstances(transforms, cubies.size(),
+				[&](int id) { return cubies[id].transform; },
+				[&](int id) { return cubies[id].faceColors; },
+				[&](int id) { return IsCubieSelected(id); });
+		}
+		cubieRenderer.Cull(transforms, frustum);
+		cubieRenderer.Draw(shader);
+	}
+	// Color index -> atlas UVs, uploaded once to the instanced programs (stickers and cubies)
+	void SetupInstancedShader(const Shader& shader) const {
+		stickerRenderer.SetPalette(shader, STICKER_PALETTE);
+		shader.setInt("entryTexture", 0);
+	}
+	// Big cubes: every sticker in one instanced draw call.
+	// The instance buffer is only rebuilt when a layer moved or the selection changed.
+	void DrawStickers(const Shader& shader, const Frustum& frustum) {
+		if (stickerRenderer.dirty) {
+			stickerRenderer.UpdateInstances(
+				[&](int id) { return transforms.Affine(cubies[id].transform); },
+				[&](int id) { return IsCubieSelected(id); });
+		}
+		stickerRenderer.Cull(frustum);
+		stickerRenderer.Draw(shader);
 	}
 	void SwitchDirection(){
 		direction *= -1;
 	}
 	
-	void AdjustRotationValues(std::string i) {
-
-		if (i == "U") {
-			if (direction < 0) SwitchDirection(); // Debe ser 1.0
-			RotateSlice(Axis::Y, 1);
-		}
-		else if (i == "U'") {
-			if (direction > 0) SwitchDirection(); // Debe ser -1.0
-			RotateSlice(Axis::Y, 1);
-		}
-		else if (i == "R") {
-			if (direction < 0) SwitchDirection(); // Debe ser 1.0
-			RotateSlice(Axis::X, 1);
-		}
-		else if (i == "R'") {
-			if (direction > 0) SwitchDirection(); // Debe ser -1.0
-			RotateSlice(Axis::X, 1);
-		}
-		else if (i == "F") {
-			if (direction < 0) SwitchDirection(); // Debe ser 1.0
-			RotateSlice(Axis::Z, 1);
-		}
-		else if (i == "F'") {
-			if (direction > 0) SwitchDirection(); // Debe ser -1.0
-			RotateSlice(Axis::Z, 1);
-		}
+	// Translate a face move ("U", "R'", ...) or an inner slice of a bigger cube ("3R", "2L'": the layer
+	// that many from that face, as getMoveString writes them) into the layer turn that performs it.
+	// Returns false for anything we cannot play.
+	bool ParseMove(const std::string& i, Move& out) {
+		size_t pos = 0;
+		int depth = 0;
+		while (pos < i.size() && std::isdigit((unsigned char)i[pos])) depth = depth * 10 + (i[pos++] - '0');
+		if (pos == 0) depth = 1;
+		if (depth < 1 || depth > N) return false;
+		if (pos >= i.size() || i.size() - pos > 2) return false;
+		if (i.size() - pos == 2 && i[pos + 1] != '\'') return false;
+		bool prime = (i.size() - pos == 2);
+		bool positiveFace = true;
+		switch (i[pos]) {
+			case 'U': out.axis = Axis::Y; break;
+			case 'D': out.axis = Axis::Y; positiveFace = false; break;
+			case 'R': out.axis = Axis::X; break;
+			case 'L': out.axis = Axis::X; positiveFace = false; break;
+			case 'F': out.axis = Axis::Z; break;
+			case 'B': out.axis = Axis::Z; positiveFace = false; break;
+			default: return false;
+		}
+		out.layer = positiveFace ? N - depth : depth - 1;
+		// Positive faces (U, R, F) turn clockwise with +1, negative faces (D, L, B) with -1
+		out.direction = positiveFace ? 1 : -1;
+		if (prime) out.direction = -out.direction;
+		return true;
+	}
 
-		else if (i == "D") {
-			if (direction > 0) SwitchDirection(); // Debe ser -1.0
-			RotateSlice(Axis::Y, -1);
-		}
-		else if (i == "D'") {
-			if (direction < 0) SwitchDirection(); // Debe ser 1.0
-			RotateSlice(Axis::Y, -1);
-		}
-		else if (i == "L") {
-			if (direction > 0) SwitchDirection(); // Debe ser -1.0
-			RotateSlice(Axis::X, -1);
-		}
-		else if (i == "L'") {
-			if (direction < 0) SwitchDirection(); // Debe ser 1.0
-			RotateSlice(Axis::X, -1);
-		}
-		else if (i == "B") {
-			if (direction > 0) SwitchDirection(); // Debe ser -1.0
-			RotateSlice(Axis::Z, -1);
-		}
-		else if (i == "B'") {
-			if (direction < 0) SwitchDirection(); // Debe ser 1.0
-			RotateSlice(Axis::Z, -1);
-		}
-		else {
+	void AdjustRotationValues(std::string i) {
+		Move move;
+		if (!ParseMove(i, move)) {
 			std::cout << "--------------- INVALID MOVE: " << i << " --------------- \n";
+			return;
 		}
+		if ((direction > 0) != (move.direction > 0)) SwitchDirection();
+		RotateSlice(move.axis, move.layer);
 	}
     
 	std::vector<std::string> ParseMoves(const std::string& s)
@@ -622,9 +722,12 @@ void FinalizeSliceRotation(Axis axis, int layer, float fullAngle) {
 
 		for (size_t i = 0; i < s.size(); ++i)
 		{
-			if (std::isalpha(s[i])) 
+			// Slice depth in front of the face ("3R"), kept with it
+			std::string depth;
+			while (i < s.size() && std::isdigit((unsigned char)s[i])) depth += s[i++];
+			if (i < s.size() && std::isalpha(s[i])) 
 			{
-				char face = s[i];
+				std::string face = depth + s[i];
 				token = face;
 				// Check next character
 				if (i + 1 < s.size())
@@ -632,7 +735,7 @@ void FinalizeSliceRotation(Axis axis, int layer, float fullAngle) {
 					// Prime move (R')
 					if (s[i+1] == '\'')
 					{
-						token = std::string(1, face) + "'";
+						token = face + "'";
 						moves.push_back(token);
 						i++; // skip '
 						continue;
@@ -641,8 +744,8 @@ void FinalizeSliceRotation(Axis axis, int layer, float fullAngle) {
 					if (s[i+1] == '2')
 					{
 						// push the face twice
-						moves.push_back(std::string(1, face));
-						moves.push_back(std::string(1, face));
+						moves.push_back(face);
+						moves.push_back(face);
 						i++; // skip 2
 						continue;
 					}
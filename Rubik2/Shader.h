@@ -4,7 +4,23 @@
 #include <sstream>
 #include <iostream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
 #include "Mesh.h"
+#include "ProgramCache.h"
+
+// Typed handle to one uniform of a program.
+// Look it up once with Shader::GetUniform<T>("name"), then set it every frame with Shader::set,
+// no string building and no glGetUniformLocation in the hot path.
+template <typename T>
+class Uniform {
+public:
+    int location = -1; // -1 = not an active uniform, glUniform* ignores it
+};
+
+// Binding points of the uniform blocks shared by every program (see UniformBlocks.h)
+enum UniformBlockBinding { FRAME_DATA_BINDING = 0, LIGHTING_BINDING = 1 };
 
 class Shader {
 public:
@@ -38,14 +54,88 @@ public:
         } catch (std::ifstream::failure& e) {
             std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
         }
+        auto buildStart = std::chrono::steady_clock::now();
+        // Same sources on the same driver as last time: no compiling at all
+        ID = ProgramCache::Load(vertexCode, fragmentCode);
+        bool fromCache = ID != 0;
+        if (!fromCache) Compile(vertexCode, fragmentCode);
+        CacheUniforms();
+        BindUniformBlock("FrameData", FRAME_DATA_BINDING);
+        BindUniformBlock("Lighting", LIGHTING_BINDING);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+        ProgramCache::totalMs += ms;
+        (fromCache ? ProgramCache::loaded : ProgramCache::compiled)++;
+        std::cout << "Shader " << vertexPath << " + " << fragmentPath << (fromCache ? ": from cache, " : ": compiled, ")
+                  << ms << " ms" << std::endl;
+    }
+
+    // Activate shader
+    void use() const { 
+        glUseProgram(ID);
+    }
+    
+    // Location of an active uniform from the table built after linking.
+    // Unknown names (typo, or optimized out by the compiler) are reported once.
+    int Location(const std::string &name) const {
+        auto it = uniformLocations.find(name);
+        if (it != uniformLocations.end()) return it->second;
+        if (reportedMissing.insert(name).second)
+            std::cerr << "WARNING::SHADER: uniform '" << name << "' is not active in program " << ID << std::endl;
+        return -1;
+    }
+    template <typename T>
+    Uniform<T> GetUniform(const std::string &name) const {
+        Uniform<T> handle;
+        handle.location = Location(name);
+        return handle;
+    }
+
+    // Typed setters, for handles
+    void set(Uniform<bool> u, bool value) const { glUniform1i(u.location, (int)value); }
+    void set(Uniform<int> u, int value) const { glUniform1i(u.location, value); }
+    void set(Uniform<float> u, float value) const { glUniform1f(u.location, value); }
+    void set(Uniform<vec3> u, const vec3& value) const { glUniform3f(u.location, value.x, value.y, value.z); }
+    void set(Uniform<matrix3> u, const matrix3& mat) const { glUniformMatrix3fv(u.location, 1, GL_FALSE, mat.m); }
+    void set(Uniform<matrix4> u, const matrix4& mat) const { glUniformMatrix4fv(u.location, 1, GL_FALSE, mat.m); }
+    // Column-major mat4 in a plain array (TransformStore::Model)
+    void set(Uniform<matrix4> u, const float* mat) const { glUniformMatrix4fv(u.location, 1, GL_FALSE, mat); }
+    void set(Uniform<matrix4> u, const affine& a) const {
+        float mat[16];
+        a.ToMatrix4(mat);
+        glUniformMatrix4fv(u.location, 1, GL_FALSE, mat);
+    }
+
+    // uniform functions, by name (cached location, fine outside the hot path)
+    void setBool(const std::string &name, bool value) const {         
+        glUniform1i(Location(name), (int)value); 
+    }
+    void setInt(const std::string &name, int value) const { 
+        glUniform1i(Location(name), value); 
+    }
+    void setFloat(const std::string &name, float value) const { 
+        glUniform1f(Location(name), value); 
+    }
+    void setVec3(const std::string &name, const vec3& value) const {
+        glUniform3f(Location(name), value.x, value.y, value.z);
+    }
+    void setVec4(const std::string &name, float x, float y, float z, float w) const {
+        glUniform4f(Location(name), x, y, z, w);
+    }
+    void setMat4(const std::string &name, const matrix4& mat) const {
+        glUniformMatrix4fv(Location(name), 1, GL_FALSE, mat.m);
+    }
+    
+private:
+    // name -> location of every active uniform, filled once after linking
+    std::unordered_map<std::string, int> uniformLocations;
+    mutable std::unordered_set<std::string> reportedMissing;
+
+    // -- Compile shaders --
+    void Compile(const std::string& vertexCode, const std::string& fragmentCode) {
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
-
-        // -- Compile shaders --
         unsigned int vertex, fragment;
-        int success;
-        char infoLog[512];
-        
         // Vertex Shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
@@ -60,39 +150,48 @@ public:
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
+        ProgramCache::PrepareForLink(ID);
         glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        if (checkCompileErrors(ID, "PROGRAM")) ProgramCache::Store(vertexCode, fragmentCode, ID);
         // Delete the shaders 
 		// Since they're linked into our program, they are no longer necessary...(?)
         glDeleteShader(vertex);
         glDeleteShader(fragment);
     }
 
-    // Activate shader
-    void use() const { 
-        glUseProgram(ID);
-    }
-    
-    // uniform functions
-    void setBool(const std::string &name, bool value) const {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
-    }
-    void setInt(const std::string &name, int value) const { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
-    }
-    void setFloat(const std::string &name, float value) const { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
-    }
-    void setVec3(const std::string &name, const vec3& value) const {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z);
+    // GLSL 330 has no layout(binding = ...), so blocks are attached here. Programs without the block skip it.
+    void BindUniformBlock(const char* blockName, unsigned int binding) {
+        unsigned int index = glGetUniformBlockIndex(ID, blockName);
+        if (index != GL_INVALID_INDEX) glUniformBlockBinding(ID, index, binding);
     }
-    void setMat4(const std::string &name, const matrix4& mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, mat.m);
+    void CacheUniforms() {
+        int count = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        char name[256];
+        for (int i = 0; i < count; ++i) {
+            int length = 0, size = 0;
+            unsigned int type = 0;
+            glGetActiveUniform(ID, (unsigned int)i, sizeof(name), &length, &size, &type, name);
+            std::string uniformName(name, length);
+            int location = glGetUniformLocation(ID, uniformName.c_str());
+            if (location < 0) continue; // block members (UBOs) have no location
+            uniformLocations[uniformName] = location;
+            // Arrays are reported once as "name[0]", add "name" and every element
+            const std::string first = "[0]";
+            if (uniformName.size() > first.size() &&
+                uniformName.compare(uniformName.size() - first.size(), first.size(), first) == 0) {
+                std::string base = uniformName.substr(0, uniformName.size() - first.size());
+                uniformLocations[base] = location;
+                for (int e = 1; e < size; ++e) {
+                    std::string element = base + "[" + std::to_string(e) + "]";
+                    uniformLocations[element] = glGetUniformLocation(ID, element.c_str());
+                }
+            }
+        }
     }
-    
-private:
-    // Check shader compilation and/or linking errors.
-    void checkCompileErrors(unsigned int shader, std::string type) {
+
+    // Check shader compilation and/or linking errors. True when it went fine.
+    bool checkCompileErrors(unsigned int shader, std::string type) {
         int success;
         char infoLog[1024];
         if (type != "PROGRAM") {
@@ -108,6 +207,7 @@ private:
                 std::cerr << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 // -----------
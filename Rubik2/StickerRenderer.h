@@ -0,0 +1,173 @@
+#pragma once
+#include <vector>
+#include <array>
+#include "Shader.h"
+#include "Frustum.h"
+#include "MeshRegistry.h"
+
+/*
+Sticker-only renderer for big NxN cubes.
+Instead of one Mesh (VAO/VBO/EBO) per cubie, every visible sticker is an instance
+of ONE shared unit quad. Per instance we send:
+ - model matrix (position + orientation of the sticker = cubie transform * face transform)
+ - color index (into the atlas palette, see sticker.vs)
+ - selected flag (for the slice highlight)
+So the whole cube is a single glDrawElementsInstanced, whatever N is.
+*/
+
+// Faces of a cubie, same order as CreateRubikCubieMesh
+enum CubieFace { FACE_FRONT, FACE_BACK, FACE_LEFT, FACE_RIGHT, FACE_BOTTOM, FACE_TOP };
+
+constexpr float STICKER_SCALE = 0.92f; // leave a dark border between stickers
+
+class Sticker {
+public:
+    int owner;       // cubie index
+    int colorIndex;  // palette slot
+    affine local;    // quad -> cubie face, in cubie space
+};
+
+class StickerInstance {
+public:
+    float model[16];
+    float colorIndex;
+    float selected;
+};
+
+class StickerRenderer {
+public:
+    std::vector<Sticker> stickers;
+    std::vector<StickerInstance> instances;
+    const Mesh* quad = nullptr; // shared (MeshRegistry)
+    unsigned int VAO = 0;       // ours: the quad's buffers + the instance attributes
+    unsigned int instanceVBO = 0;
+    bool dirty = true; // instance data must be rebuilt before the next draw
+    size_t drawCount = 0;   // instances in the buffer right now (all, or the visible ones after Cull)
+    bool compacted = false; // the buffer holds only the visible instances
+    bool pending = false; // instance data rebuilt, not uploaded yet (Cull does)
+
+    // GL objects, call once a context exists
+    void Setup() {
+        quad = &MeshRegistry::UnitQuad();
+        VAO = quad->CreateVertexArray();
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        const int stride = sizeof(StickerInstance);
+        // mat4 = 4 vec4 attributes (locations 3..6)
+        for (int col = 0; col < 4; ++col) {
+            glVertexAttribPointer(3 + col, 4, GL_FLOAT, GL_FALSE, stride, (void*)(col * 4 * sizeof(float)));
+            glEnableVertexAttribArray(3 + col);
+            glVertexAttribDivisor(3 + col, 1);
+        }
+        glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, stride, (void*)(16 * sizeof(float))); // color index
+        glEnableVertexAttribArray(7);
+        glVertexAttribDivisor(7, 1);
+        glVertexAttribPointer(8, 1, GL_FLOAT, GL_FALSE, stride, (void*)(17 * sizeof(float))); // selected
+        glEnableVertexAttribArray(8);
+        glVertexAttribDivisor(8, 1);
+        glBindVertexArray(0);
+    }
+
+    void Clear() {
+        stickers.clear();
+        dirty = true;
+    }
+
+    // Quad (facing +Z) placed on one face of a unit cubie. Exact quarter turns, no trig.
+    static constexpr affine FaceTransform(CubieFace face) {
+        affine R, T, S;
+        S.Scale(STICKER_SCALE, STICKER_SCALE, 1.0f);
+        switch (face) {
+            case FACE_FRONT:  T.Translate(0.0f, 0.0f, 0.5f); break;
+            case FACE_BACK:   R.QuarterTurn(1, 2);  T.Translate(0.0f, 0.0f, -0.5f); break;
+            case FACE_LEFT:   R.QuarterTurn(1, -1); T.Translate(-0.5f, 0.0f, 0.0f); break;
+            case FACE_RIGHT:  R.QuarterTurn(1, 1);  T.Translate(0.5f, 0.0f, 0.0f); break;
+            case FACE_BOTTOM: R.QuarterTurn(0, 1);  T.Translate(0.0f, -0.5f, 0.0f); break;
+            case FACE_TOP:    R.QuarterTurn(0, -1); T.Translate(0.0f, 0.5f, 0.0f); break;
+        }
+        return T * R * S;
+    }
+
+    void AddSticker(int owner, CubieFace face, int colorIndex) {
+        Sticker s;
+        s.owner = owner;
+        s.colorIndex = colorIndex;
+        s.local = FaceTransform(face);
+        stickers.push_back(s);
+        dirty = true;
+    }
+
+    // Rebuild the instance data from the owners' current state (uploaded by Cull).
+    // ownerModel(i) -> affine (TransformStore::Affine), ownerSelected(i) -> bool, for cubie i.
+    template <typename ModelFn, typename SelectedFn>
+    void UpdateInstances(ModelFn ownerModel, SelectedFn ownerSelected) {
+        instances.resize(stickers.size());
+        for (size_t i = 0; i < stickers.size(); ++i) {
+            const Sticker& s = stickers[i];
+            (ownerModel(s.owner) * s.local).ToMatrix4(instances[i].model);
+            instances[i].colorIndex = (float)s.colorIndex;
+            instances[i].selected = ownerSelected(s.owner) ? 1.0f : 0.0f;
+        }
+        pending = true;
+        dirty = false;
+    }
+
+    // Frustum culling over the instances, before the draw (see CubieRenderer::Cull)
+    void Cull(const Frustum& frustum) {
+        const size_t stride = sizeof(StickerInstance) / sizeof(float);
+        size_t visibleCount = instances.empty() ? 0
+            : CullInstances(frustum, quad->boundingSphere, instances[0].model, instances.size(), stride, visible);
+        CullStats::Count(visibleCount, instances.size() - visibleCount);
+        if (visibleCount == instances.size()) {
+            if (pending || compacted) Upload(instances.data(), instances.size());
+            compacted = false;
+            pending = false;
+            return;
+        }
+        // Nothing moved and nothing came into or left the view: the compacted buffer is current
+        if (!pending && compacted && visible == uploadedVisible) return;
+        visibleInstances.resize(visibleCount);
+        for (size_t i = 0; i < visibleCount; ++i) visibleInstances[i] = instances[visible[i]];
+        Upload(visibleInstances.data(), visibleCount);
+        uploadedVisible = visible;
+        compacted = true;
+        pending = false;
+    }
+
+    // Palette: one atlas UV range per color index
+    void SetPalette(const Shader& shader, const std::vector<UVRange>& palette) const {
+        shader.use();
+        for (size_t i = 0; i < palette.size(); ++i) {
+            shader.setVec4("paletteUV[" + std::to_string(i) + "]",
+                           palette[i].uMin, palette[i].vMin, palette[i].uMax, palette[i].vMax);
+        }
+    }
+
+    // One draw call for every (visible) sticker
+    void Draw(const Shader& shader) const {
+        if (drawCount == 0) return;
+        shader.use();
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        // There is no cube body behind the stickers: without culling the far side
+        // shows through the gaps (inside-out)
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_BACK);
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)quad->indices.size(), GL_UNSIGNED_INT, 0, (GLsizei)drawCount);
+        glDisable(GL_CULL_FACE);
+    }
+
+private:
+    // Scratch for Cull, keeps its capacity
+    std::vector<int> visible;
+    std::vector<int> uploadedVisible; // the visible list in the compacted buffer
+    std::vector<StickerInstance> visibleInstances;
+
+    void Upload(const StickerInstance* data, size_t count) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        // Orphan + refill, the driver does not have to wait for the previous frame
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(StickerInstance), data, GL_STREAM_DRAW);
+        drawCount = count;
+    }
+};
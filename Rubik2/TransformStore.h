@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include "MatrixOperations.h"
+
+/*
+Transforms of many small objects (cubies, tetris blocks) as structure of arrays.
+The objects keep only a handle (index) and their cold logic data (grid position, colors, ...).
+Per entry, in one array each:
+ - position: resting position
+ - rotation: resting rotation, column-major 3x3, rotation only (so it is also the normal matrix)
+ - model: the matrix that is drawn, a GPU-ready column-major mat4 (16 floats)
+Composing walks contiguous arrays, and the models array goes to an instance buffer
+(or uniforms) as it is: one upload, no per-object gathering.
+The products themselves are affine (3x4, see affine); a mat4 is only written out as the last step.
+Handles stay valid until Clear(); there is no removal of single entries.
+*/
+
+class TransformStore {
+public:
+    std::vector<vec3> positions;
+    std::vector<matrix3> rotations;
+    std::vector<float> models; // 16 floats per entry
+
+    // New entry at position, identity rotation, model already composed. Returns its handle.
+    int Create(const vec3& position = vec3()) {
+        int handle = (int)positions.size();
+        positions.push_back(position);
+        rotations.push_back(matrix3());
+        models.resize(models.size() + 16);
+        Compose(handle);
+        return handle;
+    }
+    void Clear() {
+        positions.clear();
+        rotations.clear();
+        models.clear();
+    }
+    void Reserve(size_t count) {
+        positions.reserve(count);
+        rotations.reserve(count);
+        models.reserve(count * 16);
+    }
+    size_t Size() const { return positions.size(); }
+
+    void SetPosition(int handle, const vec3& position) { positions[handle] = position; }
+    // Column-major 3x3 (matrix3 / ORIENTATION_TABLES.columns layout)
+    void SetRotation(int handle, const float columns[9]) {
+        for (int k = 0; k < 9; ++k) rotations[handle].m[k] = columns[k];
+    }
+
+    // model = [rotation | position]
+    void Compose(int handle) {
+        ComposeInto(handle, &models[handle * 16]);
+    }
+    // model = turn * [rotation | position]: the resting pose carried by a rotation around the origin
+    // (a layer in the middle of its turn)
+    void ComposeTurning(int handle, const affine& turn) {
+        (turn * Rest(handle)).ToMatrix4(&models[handle * 16]);
+    }
+    void ComposeAll() {
+        for (size_t i = 0; i < positions.size(); ++i) ComposeInto((int)i, &models[i * 16]);
+    }
+
+    const float* Model(int handle) const { return &models[handle * 16]; }
+    // The same model as a 3x4 (the mat4 without its 0 0 0 1 row), for further CPU-side products
+    affine Affine(int handle) const {
+        const float* model = &models[handle * 16];
+        affine a;
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 3; ++r) a.m[c * 3 + r] = model[c * 4 + r];
+        return a;
+    }
+    // Resting pose [rotation | position]
+    affine Rest(int handle) const {
+        const float* r = rotations[handle].m;
+        const vec3& p = positions[handle];
+        affine a;
+        for (int k = 0; k < 9; ++k) a.m[k] = r[k];
+        a.m[9] = p.x; a.m[10] = p.y; a.m[11] = p.z;
+        return a;
+    }
+    const matrix3& NormalMatrix(int handle) const { return rotations[handle]; }
+
+private:
+    void ComposeInto(int handle, float* out) const {
+        Rest(handle).ToMatrix4(out);
+    }
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include "Shader.h"
+
+/*
+Per-frame data shared by every program through std140 uniform blocks.
+One buffer write per block updates all programs, whatever their number.
+
+The GLSL side (copy into every shader that needs it):
+
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+struct Light { vec3 position; vec3 ambient; vec3 diffuse; vec3 specular; float constant; float linear; float quadratic; };
+struct Material { vec3 specular; float shininess; };
+layout (std140) uniform Lighting {
+    Light light;
+    Material material;
+};
+
+The structs below mirror the std140 layout byte for byte (vec3 = 16 byte aligned, a float can
+fill the 4th slot after a vec3, structs are padded to 16). Binding points are in Shader.h.
+*/
+
+class FrameDataBlock {
+public:
+    float projection[16]; // offset 0
+    float view[16];       // offset 64
+    float viewPos[3];     // offset 128
+    float pad0;
+
+    void Set(const matrix4& proj, const matrix4& viewMatrix, const vec3& cameraPos) {
+        std::copy(proj.m, proj.m + 16, projection);
+        std::copy(viewMatrix.m, viewMatrix.m + 16, view);
+        viewPos[0] = cameraPos.x; viewPos[1] = cameraPos.y; viewPos[2] = cameraPos.z;
+    }
+};
+static_assert(sizeof(FrameDataBlock) == 144, "FrameDataBlock must match the std140 layout");
+
+class LightingBlock {
+public:
+    // struct Light, offset 0
+    float position[3]; float pad0;
+    float ambient[3];  float pad1;
+    float diffuse[3];  float pad2;
+    float specular[3];
+    float constant = 1.0f; // attenuation (offset 60, packed after specular)
+    float linear = 0.0f;
+    float quadratic = 0.0f;
+    float pad3[2];
+    // struct Material, offset 80
+    float materialSpecular[3];
+    float materialShininess;
+
+    void SetLight(const vec3& pos, const vec3& amb, const vec3& diff, const vec3& spec) {
+        Copy(pos, position); Copy(amb, ambient); Copy(diff, diffuse); Copy(spec, specular);
+    }
+    void SetAttenuation(float c, float l, float q) {
+        constant = c; linear = l; quadratic = q;
+    }
+    void SetMaterial(const vec3& spec, float shininess) {
+        Copy(spec, materialSpecular);
+        materialShininess = shininess;
+    }
+private:
+    static void Copy(const vec3& v, float* out) { out[0] = v.x; out[1] = v.y; out[2] = v.z; }
+};
+static_assert(sizeof(LightingBlock) == 96, "LightingBlock must match the std140 layout");
+
+// GL buffer behind one block, bound once to its binding point
+template <typename Block>
+class UniformBuffer {
+public:
+    unsigned int UBO = 0;
+
+    void Setup(unsigned int binding) {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    // The whole block in one write
+    void Upload(const Block& data) const {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+};
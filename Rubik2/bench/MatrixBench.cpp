@@ -0,0 +1,205 @@
+/*
+Microbenchmark of the matrix kernels (MatrixKernels.h) against the code they replaced:
+ - 4x4 multiply: old triple loop vs scalar kernel vs SIMD kernel
+ - point transform: old multVect vs SIMD kernel
+ - batch transform of packed xyz points
+ - interleaved mesh vertices (Mesh::UpdateVertices): old copy + loop vs the vertex kernels
+Also checks that every version gives the same numbers.
+
+Usage: MatrixBench [iterations]   (build Release, the default of this project)
+*/
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include "../MatrixOperations.h"
+
+// matrix4::operator* and multVect before the kernels, kept verbatim as the baseline
+static matrix4 OldMultiply(const matrix4& a, const matrix4& other) {
+    matrix4 result;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j) {
+            result.m[i + j * 4] = 0.0f;
+            for (int k = 0; k < 4; ++k)
+                result.m[i + j * 4] += a.m[i + k * 4] * other.m[k + j * 4];
+        }
+    return result;
+}
+static void OldMultVect(const float m[16], float& x, float& y, float& z) {
+    float tx = m[0]*x + m[4]*y + m[8]*z + m[12];
+    float ty = m[1]*x + m[5]*y + m[9]*z + m[13];
+    float tz = m[2]*x + m[6]*y + m[10]*z + m[14];
+    float tw = m[3]*x + m[7]*y + m[11]*z + m[15];
+    if (tw != 0.0f && tw != 1.0f) {
+        tx /= tw;
+        ty /= tw;
+        tz /= tw;
+    }
+    x = tx;
+    y = ty;
+    z = tz;
+}
+
+// Keeps the compiler from dropping the work
+static volatile float g_sink;
+
+template <typename Fn>
+static double NanosecondsPerOp(size_t ops, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (double)ops;
+}
+
+static void Report(const std::string& name, double ns, double baseline) {
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << std::setw(9) << std::fixed
+              << std::setprecision(2) << ns << " ns/op   x" << std::setprecision(2) << baseline / ns << "\n";
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? (size_t)std::atoll(argv[1]) : 2000000;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    // A pool of model-like matrices (rotation + translation) so the loops do not see constants
+    const size_t POOL = 256;
+    std::vector<matrix4> pool(POOL);
+    for (matrix4& mat : pool) {
+        matrix4 rx, ry, t;
+        rx.RotateX(dist(rng) * 3.0f);
+        ry.RotateY(dist(rng) * 3.0f);
+        t.Translate(dist(rng) * 5.0f, dist(rng) * 5.0f, dist(rng) * 5.0f);
+        mat = OldMultiply(t, OldMultiply(rx, ry));
+    }
+    std::cout << "Kernels: " << MatrixKernelName() << ", " << iterations << " iterations\n";
+
+    // --- Correctness ---
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < POOL; ++i) {
+        const matrix4& a = pool[i];
+        const matrix4& b = pool[(i * 7 + 3) % POOL];
+        matrix4 ref = OldMultiply(a, b), simd = a * b, scalar;
+        Mat4MulScalar(a.m, b.m, scalar.m);
+        for (int k = 0; k < 16; ++k)
+            maxDiff = std::max(maxDiff, std::max(std::fabs(ref.m[k] - simd.m[k]), std::fabs(ref.m[k] - scalar.m[k])));
+        float x = dist(rng), y = dist(rng), z = dist(rng);
+        float ox = x, oy = y, oz = z, nx = x, ny = y, nz = z;
+        OldMultVect(a.m, ox, oy, oz);
+        matrix4().multVect(a.m, nx, ny, nz);
+        maxDiff = std::max(maxDiff, std::max(std::fabs(ox - nx), std::max(std::fabs(oy - ny), std::fabs(oz - nz))));
+    }
+    std::cout << "Max difference vs old code: " << maxDiff << (maxDiff < 1e-4f ? " (ok)\n" : " (MISMATCH)\n");
+
+    // --- 4x4 multiply ---
+    std::cout << "matrix4 * matrix4\n";
+    double oldMul = NanosecondsPerOp(iterations, [&] {
+        matrix4 acc = pool[0];
+        for (size_t i = 0; i < iterations; ++i) acc = OldMultiply(pool[i % POOL], acc);
+        g_sink = acc.m[0];
+    });
+    double scalarMul = NanosecondsPerOp(iterations, [&] {
+        matrix4 acc = pool[0], tmp;
+        for (size_t i = 0; i < iterations; ++i) { Mat4MulScalar(pool[i % POOL].m, acc.m, tmp.m); acc = tmp; }
+        g_sink = acc.m[0];
+    });
+    double simdMul = NanosecondsPerOp(iterations, [&] {
+        matrix4 acc = pool[0];
+        for (size_t i = 0; i < iterations; ++i) acc = pool[i % POOL] * acc;
+        g_sink = acc.m[0];
+    });
+    Report("old triple loop", oldMul, oldMul);
+    Report("scalar kernel", scalarMul, oldMul);
+    Report(std::string(MatrixKernelName()) + " kernel (operator*)", simdMul, oldMul);
+
+    // --- Single point transform ---
+    std::cout << "multVect (one point)\n";
+    double oldVec = NanosecondsPerOp(iterations, [&] {
+        float x = 0.1f, y = 0.2f, z = 0.3f;
+        for (size_t i = 0; i < iterations; ++i) {
+            OldMultVect(pool[i % POOL].m, x, y, z);
+            x *= 0.5f; y *= 0.5f; z *= 0.5f; // keep the values bounded
+        }
+        g_sink = x + y + z;
+    });
+    double simdVec = NanosecondsPerOp(iterations, [&] {
+        float x = 0.1f, y = 0.2f, z = 0.3f;
+        matrix4 helper;
+        for (size_t i = 0; i < iterations; ++i) {
+            helper.multVect(pool[i % POOL].m, x, y, z);
+            x *= 0.5f; y *= 0.5f; z *= 0.5f;
+        }
+        g_sink = x + y + z;
+    });
+    Report("old multVect", oldVec, oldVec);
+    Report(std::string(MatrixKernelName()) + " multVect", simdVec, oldVec);
+
+    // --- Batch transform ---
+    const size_t POINTS = 4096;
+    size_t rounds = std::max<size_t>(1, iterations / POINTS);
+    std::vector<float> points(POINTS * 3), out(POINTS * 3);
+    for (float& p : points) p = dist(rng);
+    std::cout << "Batch transform, " << POINTS << " points x " << rounds << "\n";
+    double oldBatch = NanosecondsPerOp(rounds * POINTS, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            const float* m = pool[r % POOL].m;
+            for (size_t i = 0; i < POINTS; ++i) {
+                float x = points[i * 3], y = points[i * 3 + 1], z = points[i * 3 + 2];
+                OldMultVect(m, x, y, z);
+                out[i * 3] = x; out[i * 3 + 1] = y; out[i * 3 + 2] = z;
+            }
+            g_sink = out[r % out.size()];
+        }
+    });
+    double scalarBatch = NanosecondsPerOp(rounds * POINTS, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            Mat4TransformPointsScalar(pool[r % POOL].m, points.data(), out.data(), POINTS);
+            g_sink = out[r % out.size()];
+        }
+    });
+    double simdBatch = NanosecondsPerOp(rounds * POINTS, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            Mat4TransformPointsSIMD(pool[r % POOL].m, points.data(), out.data(), POINTS);
+            g_sink = out[r % out.size()];
+        }
+    });
+    Report("old multVect loop", oldBatch, oldBatch);
+    Report("scalar batch kernel", scalarBatch, oldBatch);
+    Report(std::string(MatrixKernelName()) + " batch kernel", simdBatch, oldBatch);
+
+    // --- Mesh vertices (Mesh::UpdateVertices) ---
+    // Old path: copy the vertex vector, then multVect every 5th float (wrong for the 8-float layout,
+    // kept as the cost baseline). New path: positions + normals straight into a preallocated buffer.
+    const size_t VERTS = 4096, STRIDE = 8;
+    std::vector<float> mesh(VERTS * STRIDE), upload(VERTS * STRIDE);
+    for (float& v : mesh) v = dist(rng);
+    std::cout << "Mesh vertices (stride 8, positions + normals), " << VERTS << " vertices x " << rounds << "\n";
+    double oldMesh = NanosecondsPerOp(rounds * VERTS, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            std::vector<float> transformed = mesh;
+            const float* m = pool[r % POOL].m;
+            for (size_t i = 0; i < transformed.size(); i += 5) OldMultVect(m, transformed[i], transformed[i + 1], transformed[i + 2]);
+            g_sink = transformed[r % transformed.size()];
+        }
+    });
+    double scalarMesh = NanosecondsPerOp(rounds * VERTS, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            const matrix4& m = pool[r % POOL];
+            Mat4TransformVerticesScalar(m.m, m.m, mesh.data(), upload.data(), VERTS, STRIDE, 5);
+            g_sink = upload[r % upload.size()];
+        }
+    });
+    double simdMesh = NanosecondsPerOp(rounds * VERTS, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            const matrix4& m = pool[r % POOL];
+            Mat4TransformVerticesSIMD(m.m, m.m, mesh.data(), upload.data(), VERTS, STRIDE, 5);
+            g_sink = upload[r % upload.size()];
+        }
+    });
+    Report("old copy + stride-5 loop", oldMesh, oldMesh);
+    Report("scalar vertex kernel", scalarMesh, oldMesh);
+    Report(std::string(MatrixKernelName()) + " vertex kernel", simdMesh, oldMesh);
+    return maxDiff < 1e-4f ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec3 aNormal;
+// Per-instance (one per cubie)
+layout (location = 3) in mat4 aModel;       // uses locations 3, 4, 5, 6
+layout (location = 7) in uint aFaceColors;  // 6 x 3-bit palette index: front, back, left, right, bottom, top
+layout (location = 8) in float aSelected;
+
+out vec2 TexCoord;
+out vec3 Normal;
+out vec3 FragPos;
+out float Selected;
+out vec2 FaceUV; // 0..1 across the face, for the selection outline
+
+// Shared by every program, one buffer per frame (UniformBlocks.h)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos; // Camera position
+};
+// Atlas UV range (uMin, vMin, uMax, vMax) for every color index
+uniform vec4 paletteUV[7];
+
+void main()
+{
+    vec4 worldPos = aModel * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPos;
+
+    // Which face this vertex belongs to, from its (unit cube) normal
+    uint face;
+    if (aNormal.z > 0.5)       face = 0u; // front
+    else if (aNormal.z < -0.5) face = 1u; // back
+    else if (aNormal.x < -0.5) face = 2u; // left
+    else if (aNormal.x > 0.5)  face = 3u; // right
+    else if (aNormal.y < -0.5) face = 4u; // bottom
+    else                       face = 5u; // top
+    uint color = (aFaceColors >> (3u * face)) & 7u;
+    vec4 uv = paletteUV[color];
+    TexCoord = mix(uv.xy, uv.zw, aTexCoord);
+
+    FragPos = vec3(worldPos);
+    // Cubie transforms are rotation + translation, no inverse needed
+    Normal = mat3(aModel) * aNormal;
+    Selected = aSelected;
+    FaceUV = aTexCoord;
+}
@@ -3,26 +3,32 @@
 #include <cmath>
 #include "RubikCube.h"
 #include "Camera.h"
+#include "UniformBlocks.h"
+#include "RenderScheduler.h"
+#include "Headless.h"
 
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
+const int CUBE_SIZE = 3; // N x N x N
 //Update after input?
 bool needsUpdate = true;
 // Camera Orbit Variables
-float ORBIT_RADIUS = 6.0f; 
+float ORBIT_RADIUS = 2.0f * CUBE_SIZE; 
 float orbitAngleY = PI/4.0f; // Horizontal angle (Yaw)
 float orbitAngleX = PI/4.0f; // Vertical angle (Pitch)
 const float orbitSpeed = 0.05f;
 // -- Rubik Cube variables
 Axis currentAxis = Axis::Z;
-int Slice = 1; 
+int Slice = CUBE_SIZE - 1; 
 RubikCube* g_rubikCube = nullptr;
 // -- Time/Frame Management
 float deltaTime = 0.0f; 
-float lastFrame = 0.0f;
+// Only draws when something changed or moves, sleeps otherwise
+RenderScheduler g_scheduler;
 // -- GLFW - Window and Input
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void window_refresh_callback(GLFWwindow* window);
 //std::vector<std::string> input_moves;
 
 
@@ -30,6 +36,8 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 #include <array>
 #include <cstdio>
 #include <string>
+#include <fstream>
+#include <filesystem>
 std::string RunCommand(const std::string& cmd) {
     std::array<char, 128> buffer;
     std::string result;
@@ -41,40 +49,8 @@ std::string RunCommand(const std::string& cmd) {
     return result;
 }
 
-int main() {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-glfwWindowHint(GLFW_DEPTH_BITS, 24);
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "OpenGL Window", NULL, NULL);
-    if (!window) {
-        std::cerr << "Failed to create GLFW window\n";
-        glfwTerminate();
-        return -1;
-    }
-
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetKeyCallback(window, key_callback);
-
-    if (!gladLoadGL(glfwGetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-        return -1;
-    }
-	
-	Shader cubeShader("simple.vs", "simple.fs");
-	
-// -- CAMERA SETUP --
-	Camera camera(vec3(ORBIT_RADIUS, 0.0f, 0.0f));
-	//float currentOrbitY = PI/2.0f;
-	//float currentOrbitX = 0.0f; 
-	camera.Orbit(orbitAngleY, orbitAngleX, ORBIT_RADIUS, vec3(0.0f));
-	glEnable(GL_DEPTH_TEST);
 // -- LIGHTS AND MATERIAL CONFIG --
+void SetupLighting(UniformBuffer<LightingBlock>& lightingBuffer) {
 	vec3 lightPos(2.0f, 3.0f, 4.0f); 
     vec3 lightAmbient(0.3f, 0.3f, 0.3f);
     vec3 lightDiffuse(1.0f, 1.0f, 1.0f);
@@ -82,11 +58,19 @@ glfwWindowHint(GLFW_DEPTH_BITS, 24);
 	//Material
 	vec3 materialSpecular(0.8f, 0.8f, 0.8f); //More to reflect MORE! *Sigh*///
     float materialShininess = 64.0f;   //More = sharper = smaller highlight
+	// Lighting does not change, it is uploaded once here.
+	lightingBuffer.Setup(LIGHTING_BINDING);
+	LightingBlock lighting;
+	lighting.SetLight(lightPos, lightAmbient, lightDiffuse, lightSpecular);
+	lighting.SetMaterial(materialSpecular, materialShininess);
+	lightingBuffer.Upload(lighting);
+}
 
 // -- Textures Config --
+unsigned int LoadCubeTexture() {
 	unsigned int texture;
 	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);cubeShader.setInt("entryTexture", 0);
+	glBindTexture(GL_TEXTURE_2D, texture);
 	// Texture parameters
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -111,67 +95,210 @@ glfwWindowHint(GLFW_DEPTH_BITS, 24);
 		std::cerr << "Failed to load texture\n";
 	}
 	stbi_image_free(data);
+	return texture;
+}
+
+// Frame uniforms (projection, view and camera position for specular, one buffer write),
+// then the cube. Shared by the window loop and the headless runner.
+void RenderCube(RubikCube& cube, const Shader& shader, Camera& camera, float aspect, float dt,
+                UniformBuffer<FrameDataBlock>& frameBuffer) {
+	shader.use();
+	matrix4 projMatrix;
+	projMatrix.Perspective(camera.Zoom * (PI / 180.0f), aspect, 0.1f, 100.0f);
+	matrix4 viewMatrix = camera.GetViewMatrix();
+	FrameDataBlock frameData;
+	frameData.Set(projMatrix, viewMatrix, camera.Position);
+	frameBuffer.Upload(frameData);
+	Frustum frustum;
+	frustum.Extract(projMatrix * viewMatrix);
+	CullStats::BeginFrame();
+	// Draw the entire cube
+	cube.Update(dt);
+	cube.Draw(shader, frustum);
+}
+
+// Plays opts.moves into an offscreen framebuffer, no window. Writes the frames as PNG
+// and a timings.csv (CPU / GPU / save time per frame) to opts.outDir.
+int RunHeadless(const HeadlessOptions& opts) {
+#ifdef RUBIK_HEADLESS
+	if (!CreateHeadlessContext()) return -1;
+	OffscreenTarget target;
+	if (!target.Setup(opts.width, opts.height)) return -1;
+	std::filesystem::create_directories(opts.outDir);
+	glEnable(GL_DEPTH_TEST);
+
+	UniformBuffer<FrameDataBlock> frameBuffer;
+	frameBuffer.Setup(FRAME_DATA_BINDING);
+	UniformBuffer<LightingBlock> lightingBuffer;
+	SetupLighting(lightingBuffer);
+	LoadCubeTexture();
+
+	RubikCube rubikCube(opts.cubeSize);
+	Shader cubeShader(rubikCube.UsesStickerRenderer() ? "sticker.vs" : "cubie.vs", "sticker.fs");
+	rubikCube.SetupInstancedShader(cubeShader);
+	ProgramCache::PrintStats();
+	MeshOptimizeStats::Print();
+	MeshRegistry::PrintStats();
+	float radius = 2.0f * opts.cubeSize;
+	Camera camera(vec3(radius, 0.0f, 0.0f));
+	camera.Orbit(orbitAngleY, orbitAngleX, radius, vec3(0.0f));
+	if (!opts.moves.empty())
+		rubikCube.StartExecutingSolution(rubikCube.ParseMoves(opts.moves));
+
+	GpuTimer gpuTimer;
+	gpuTimer.Setup();
+	std::vector<FrameTiming> timings;
+	// One frame more than the animation needs, so the last image shows the final state
+	for (int frame = 0; frame < opts.maxFrames; ++frame) {
+		bool lastFrame = !rubikCube.IsAnimating();
+		FrameTiming t = { frame, 0.0, 0.0, 0.0, 0.0 };
+
+		auto cpuStart = std::chrono::steady_clock::now();
+		gpuTimer.Begin();
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		RenderCube(rubikCube, cubeShader, camera, (float)opts.width / (float)opts.height, frame == 0 ? 0.0f : opts.frameTime, frameBuffer);
+		gpuTimer.End();
+		auto submitted = std::chrono::steady_clock::now();
+		t.cpuMs = std::chrono::duration<double, std::milli>(submitted - cpuStart).count();
+		glFinish();
+		t.finishMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitted).count();
+		t.gpuMs = gpuTimer.Milliseconds();
+
+		if (opts.saveEvery > 0 && (frame % opts.saveEvery == 0 || lastFrame)) {
+			auto saveStart = std::chrono::steady_clock::now();
+			char name[32];
+			std::snprintf(name, sizeof(name), "frame_%05d.png", frame);
+			if (!target.SavePNG(opts.outDir + "/" + name))
+				std::cerr << "Could not write " << name << "\n";
+			t.saveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - saveStart).count();
+		}
+		timings.push_back(t);
+		if (lastFrame) break;
+	}
+
+	std::ofstream csv(opts.outDir + "/timings.csv");
+	csv << "frame,cpu_ms,gpu_ms,finish_ms,save_ms\n";
+	double cpuTotal = 0.0, gpuTotal = 0.0, finishTotal = 0.0, cpuMax = 0.0, gpuMax = 0.0, finishMax = 0.0;
+	for (const FrameTiming& t : timings) {
+		csv << t.frame << "," << t.cpuMs << "," << t.gpuMs << "," << t.finishMs << "," << t.saveMs << "\n";
+		cpuTotal += t.cpuMs; gpuTotal += t.gpuMs; finishTotal += t.finishMs;
+		cpuMax = std::max(cpuMax, t.cpuMs); gpuMax = std::max(gpuMax, t.gpuMs); finishMax = std::max(finishMax, t.finishMs);
+	}
+	size_t n = timings.size();
+	std::cout << n << " frames, CPU avg " << cpuTotal / n << " ms (max " << cpuMax << "), GPU avg "
+	          << gpuTotal / n << " ms (max " << gpuMax << "), glFinish avg " << finishTotal / n << " ms (max " << finishMax << ")\n";
+	CullStats::Print();
+	std::cout << "Frames and timings.csv written to " << opts.outDir << "\n";
+	return 0;
+#else
+	(void)opts;
+	std::cerr << "Built without headless support, configure with -DRUBIK_HEADLESS=ON\n";
+	return -1;
+#endif
+}
+
+int main(int argc, char** argv) {
+	HeadlessOptions headless;
+	if (!headless.Parse(argc, argv)) return -1;
+	if (headless.enabled) return RunHeadless(headless);
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+glfwWindowHint(GLFW_DEPTH_BITS, 24);
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "OpenGL Window", NULL, NULL);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+
+    if (!gladLoadGL(glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        return -1;
+    }
+	
+// -- CAMERA SETUP --
+	Camera camera(vec3(ORBIT_RADIUS, 0.0f, 0.0f));
+	//float currentOrbitY = PI/2.0f;
+	//float currentOrbitX = 0.0f; 
+	camera.Orbit(orbitAngleY, orbitAngleX, ORBIT_RADIUS, vec3(0.0f));
+	glEnable(GL_DEPTH_TEST);
+// -- LIGHTS AND MATERIAL CONFIG --
+	// Camera/projection and lighting live in uniform blocks shared by every program.
+	UniformBuffer<FrameDataBlock> frameBuffer;
+	frameBuffer.Setup(FRAME_DATA_BINDING);
+	UniformBuffer<LightingBlock> lightingBuffer;
+	SetupLighting(lightingBuffer);
+// -- Textures Config --
+	LoadCubeTexture();
 // -- RubikCube
-	RubikCube rubikCube;
+	RubikCube rubikCube(CUBE_SIZE);
 	g_rubikCube = &rubikCube;
+	// Big cubes are drawn as instanced stickers, normal ones as instanced cubies
+	Shader cubeShader(rubikCube.UsesStickerRenderer() ? "sticker.vs" : "cubie.vs", "sticker.fs");
+	rubikCube.SetupInstancedShader(cubeShader);
+	ProgramCache::PrintStats();
+	MeshOptimizeStats::Print();
+	MeshRegistry::PrintStats();
 //----------------Main Loop---------------------
     while (!glfwWindowShouldClose(window)) {
+		// Sleep until a key, a window event or a running animation needs a frame
+		g_scheduler.SetAnimating(rubikCube.IsAnimating());
+		g_scheduler.WaitForWork();
+		if (!g_scheduler.ShouldRender()) continue;
+		// -- Time Logic --
+		deltaTime = g_scheduler.BeginFrame();
+
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT| GL_DEPTH_BUFFER_BIT);
 		
-		// -- Time Logic --
-		float currentFrame = glfwGetTime(); //glfw is convenient...
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
-		
         if (needsUpdate) {
 			rubikCube.SelectSlice(currentAxis, Slice);//
 			camera.Orbit(orbitAngleY, orbitAngleX, ORBIT_RADIUS, vec3(0.0f));
 			needsUpdate = false;
 		}
-		cubeShader.use();
-// -- LIGHT CALCULATION --
-		// Set Camera Position for Specular Calculations
-		cubeShader.setVec3("viewPos", camera.Position); // Assuming Camera class has a public 'Position' member
-		// Set Light Uniforms
-		cubeShader.setVec3("light.position", lightPos);
-		cubeShader.setVec3("light.ambient", lightAmbient);
-		cubeShader.setVec3("light.diffuse", lightDiffuse);
-		cubeShader.setVec3("light.specular", lightSpecular);
-		// Set Material
-		cubeShader.setVec3("material.specular", materialSpecular);
-		cubeShader.setFloat("material.shininess", materialShininess);
-		
-		matrix4 projMatrix;
-		projMatrix.Perspective(camera.Zoom * (PI / 180.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-		cubeShader.setMat4("projection", projMatrix);
-		// Set View Matrix (Updates every frame/input)
-		cubeShader.setMat4("view", camera.GetViewMatrix());
-		// Draw the entire cube
-		rubikCube.Update(deltaTime);
-		rubikCube.Draw(cubeShader);
+		RenderCube(rubikCube, cubeShader, camera, (float)SCR_WIDTH / (float)SCR_HEIGHT, deltaTime, frameBuffer);
         glfwSwapBuffers(window);
-        glfwPollEvents();
+		g_scheduler.EndFrame();
     }
 
+	g_scheduler.PrintStats();
+	CullStats::Print();
     glfwTerminate();
     return 0;
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    g_scheduler.RequestRedraw();
+}
+
+// Window uncovered / resized, the old frame is gone
+void window_refresh_callback(GLFWwindow* window) {
+    g_scheduler.RequestRedraw();
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-    
+    // Every key can change what is on screen, draw one frame for it
+	g_scheduler.RequestRedraw();
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
 		if (g_rubikCube->isRotating) return;
 		//std::cout << "Layer Changed \n";
-        if (Slice == 0) Slice = 1;
-		else if (Slice == 1) Slice = -1;
-		else Slice = Slice = 0;
+		// Outer layer first, then every other layer in order
+		Slice = (Slice + 1) % g_rubikCube->GetSize();
 		needsUpdate = true;
     }
 	if (key == GLFW_KEY_X && action == GLFW_PRESS)
@@ -243,9 +370,23 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		std::cout << "Scramble Attempted --- NOT IMPLEMENTED \n";
 		needsUpdate = true;
 	}
+	if (key == GLFW_KEY_P && action == GLFW_PRESS)
+	{
+		g_scheduler.PrintStats();
+		CullStats::Print();
+	}
+	if (key == GLFW_KEY_T && action == GLFW_PRESS)
+	{
+		g_rubikCube->turboPlayback = !g_rubikCube->turboPlayback;
+		std::cout << "Turbo playback: " << (g_rubikCube->turboPlayback ? "ON" : "OFF") << "\n";
+	}
 	if (key == GLFW_KEY_V && action == GLFW_PRESS)
 	{
 		if (g_rubikCube->isRotating) return;
+		if (g_rubikCube->GetSize() != 3) {
+			std::cout << "Auto Solver only supports 3x3x3 cubes\n";
+			return;
+		}
 		std::cout << "Auto Solver Called ---\n";
 		std::string moveList = g_rubikCube->GetMoveList();
 		std::string cmd = "python solver2.py \"" + moveList + "\"";
@@ -0,0 +1,78 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 Normal;
+in vec3 FragPos;
+in float Selected;
+in vec2 FaceUV;
+
+const vec3 OUTLINE_COLOR = vec3(1.0, 1.0, 0.0); // Yellow, like the old wireframe
+const float OUTLINE_PIXELS = 3.0;
+
+uniform sampler2D entryTexture;
+
+//Light structure
+struct Light {
+    vec3 position; 
+    vec3 ambient;
+    vec3 diffuse; 
+    vec3 specular;
+    
+    // Attenuation Factors
+    float constant;  
+    float linear;
+    float quadratic;
+};
+
+//Material structure
+struct Material {
+    vec3 specular;
+    float shininess;
+};
+
+// Shared by every program (UniformBlocks.h), std140 layout
+layout (std140) uniform Lighting {
+    Light light;
+    Material material;
+};
+
+// Shared by every program, one buffer per frame (UniformBlocks.h)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos; // Camera position
+};
+
+void main() {
+    vec4 texColor = texture(entryTexture, TexCoord);
+
+    // 1. Ambient Lighting
+    vec3 ambient = light.ambient * vec3(texColor); 
+
+    // 2. Diffuse Lighting
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(light.position - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * (diff * vec3(texColor));
+
+    // 3. Specular Lighting
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);  
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = light.specular * (spec * material.specular);  
+    
+    vec3 result = ambient + diffuse + specular;
+
+    // Selected slice: outline along the face edges, in the same pass.
+    // Distance to the nearest edge in UV, divided by its screen derivative = distance in pixels,
+    // so the outline is equally thick at any zoom or angle.
+    if (Selected > 0.5) {
+        vec2 edgeDist = min(FaceUV, 1.0 - FaceUV) / max(fwidth(FaceUV), vec2(1e-6));
+        float pixels = min(edgeDist.x, edgeDist.y);
+        float outline = 1.0 - smoothstep(OUTLINE_PIXELS - 1.0, OUTLINE_PIXELS, pixels);
+        result = mix(result, OUTLINE_COLOR, outline);
+    }
+    // Final Color
+    FragColor = vec4(result, texColor.a);
+}
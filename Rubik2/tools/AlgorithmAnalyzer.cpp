@@ -0,0 +1,106 @@
+/*
+Algorithm analyzer: reads an algorithm library (one algorithm per line) and reports for each one
+ - order (how many times to repeat it to get back to solved)
+ - corner and edge permutation parity (equal for face turns, not after slice moves)
+ - cycle structure of corners, edges and centers
+ - number of affected pieces
+No window and no GL, everything runs on CubeState. Lines are split over all cores.
+
+Usage: AlgorithmAnalyzer <library.txt> [threads]   (reads stdin without a file)
+Lines starting with # are comments, "name: alg" lines keep the name in the output.
+Output is tab separated: name, order, corner parity, edge parity, corners, edges, centers, affected, state.
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "../CubeState.h"
+
+struct LibraryEntry {
+    std::string name;
+    std::string alg;
+};
+
+static std::string JoinCycles(const std::vector<std::string>& cycles) {
+    if (cycles.empty()) return "-";
+    std::string out;
+    for (const std::string& c : cycles) out += c;
+    return out;
+}
+
+static std::string AnalyzeLine(const LibraryEntry& entry) {
+    CubeState state;
+    std::string error;
+    if (!ApplyAlgorithm(state, entry.alg, &error))
+        return entry.name + "\terror: " + error;
+
+    AlgorithmInfo info = AnalyzeState(state);
+    std::ostringstream out;
+    out << entry.name << '\t'
+        << info.order << '\t'
+        << (info.cornerOddParity ? "odd" : "even") << '\t'
+        << (info.edgeOddParity ? "odd" : "even") << '\t'
+        << JoinCycles(info.cornerCycles) << '\t'
+        << JoinCycles(info.edgeCycles) << '\t'
+        << JoinCycles(info.centerCycles) << '\t'
+        << info.cornersAffected << "C " << info.edgesAffected << "E " << info.centersAffected << "X\t"
+        << state.ToFaceletString();
+    return out.str();
+}
+
+int main(int argc, char** argv) {
+    std::ifstream file;
+    if (argc > 1) {
+        file.open(argv[1]);
+        if (!file) {
+            std::cerr << "Cannot open " << argv[1] << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = argc > 1 ? static_cast<std::istream&>(file) : std::cin;
+
+    std::vector<LibraryEntry> entries;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        LibraryEntry e;
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            e.name = line.substr(0, colon);
+            e.alg = line.substr(colon + 1);
+        } else {
+            e.name = line;
+            e.alg = line;
+        }
+        entries.push_back(e);
+    }
+
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 2) threadCount = std::max(1, std::atoi(argv[2]));
+    threadCount = std::min<unsigned>(threadCount, (unsigned)std::max<size_t>(1, entries.size()));
+
+    // Build the move tables once before the workers start
+    MoveTable::Get();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> results(entries.size());
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = t; i < entries.size(); i += threadCount)
+                results[i] = AnalyzeLine(entries[i]);
+        });
+    }
+    for (std::thread& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ostringstream out;
+    out << "#name\torder\tcparity\teparity\tcorners\tedges\tcenters\taffected\tstate\n";
+    for (const std::string& r : results) out << r << '\n';
+    std::cout << out.str();
+    std::cerr << entries.size() << " algorithms in " << seconds << " s on " << threadCount << " threads" << std::endl;
+    return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include "MatrixOperations.h"
+
+/*
+Where a board cell sits on the cylinder. There are only `columns` distinct angles, so their
+radius * cos / radius * sin are computed once per Set (SetRadius) instead of once per block:
+placing a block is then a table lookup and one multiply for the height.
+*/
+class CylinderLayout {
+public:
+    int columns = 0;
+    float radius = 0.0f;
+    float cellSize = 1.0f;
+    std::vector<float> columnX; // radius * cos(angle of column)
+    std::vector<float> columnZ; // radius * sin(angle of column)
+
+    void Set(int columnCount, float r, float size) {
+        columns = columnCount;
+        radius = r;
+        cellSize = size;
+        columnX.resize(columns);
+        columnZ.resize(columns);
+        for (int i = 0; i < columns; ++i) {
+            float angle = (float(i) / columns) * 2.0f * PI_F;
+            columnX[i] = radius * std::cos(angle);
+            columnZ[i] = radius * std::sin(angle);
+        }
+    }
+    // Center of cell (x, y). x wraps around, like the board does (pieces may hang over the seam).
+    vec3 Position(int x, int y) const {
+        int column = ((x % columns) + columns) % columns;
+        return vec3(columnX[column], y * cellSize, columnZ[column]);
+    }
+
+private:
+    static constexpr float PI_F = 3.14159265359f; // Mesh.h's PI, without pulling GL in
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <iostream>
+#include "Bounds.h"
+
+/*
+View frustum culling: what is completely outside the 6 planes of projection * view is not submitted.
+Conservative (spheres and boxes, not triangles): something reported visible may still be off screen,
+something reported culled never is.
+*/
+
+class Frustum {
+	public:
+    // a, b, c, d per plane (left, right, bottom, top, near, far), normals point inwards, normalized:
+    // a point p is inside a plane when a*p.x + b*p.y + c*p.z + d >= 0, and that value is its distance
+    float planes[6][4];
+
+    // World-space planes straight from the rows of projection * view (Gribb / Hartmann)
+    void Extract(const matrix4& viewProjection) {
+        const float* m = viewProjection.m;
+        for (int p = 0; p < 6; ++p) {
+            int row = p / 2;
+            float sign = (p % 2 == 0) ? 1.0f : -1.0f;
+            // row 3 +/- row 0, 1, 2 (column-major: row r is m[r], m[4 + r], m[8 + r], m[12 + r])
+            for (int k = 0; k < 4; ++k) planes[p][k] = m[k * 4 + 3] + sign * m[k * 4 + row];
+            float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+            if (length > 0.0f)
+                for (int k = 0; k < 4; ++k) planes[p][k] /= length;
+        }
+    }
+    bool IntersectsSphere(const vec3& center, float radius) const {
+        for (int p = 0; p < 6; ++p) {
+            if (planes[p][0] * center.x + planes[p][1] * center.y + planes[p][2] * center.z + planes[p][3] < -radius) return false;
+        }
+        return true;
+    }
+    // World-space box: only the corner farthest along each plane normal needs testing
+    bool IntersectsAABB(const AABB& box) const {
+        for (int p = 0; p < 6; ++p) {
+            float x = planes[p][0] >= 0.0f ? box.max.x : box.min.x;
+            float y = planes[p][1] >= 0.0f ? box.max.y : box.min.y;
+            float z = planes[p][2] >= 0.0f ? box.max.z : box.min.z;
+            if (planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < 0.0f) return false;
+        }
+        return true;
+    }
+};
+
+// Local sphere moved by a column-major mat4 model. The radius grows with the largest axis scale,
+// so it also stays conservative for scaled models.
+inline BoundingSphere TransformSphere(const float* model, const BoundingSphere& local) {
+    BoundingSphere world;
+    const vec3& c = local.center;
+    world.center = vec3(model[0] * c.x + model[4] * c.y + model[8] * c.z + model[12],
+                        model[1] * c.x + model[5] * c.y + model[9] * c.z + model[13],
+                        model[2] * c.x + model[6] * c.y + model[10] * c.z + model[14]);
+    float scale2 = 0.0f;
+    for (int col = 0; col < 3; ++col)
+        scale2 = std::max(scale2, model[col * 4] * model[col * 4] + model[col * 4 + 1] * model[col * 4 + 1] + model[col * 4 + 2] * model[col * 4 + 2]);
+    world.radius = local.radius * std::sqrt(scale2);
+    return world;
+}
+
+// Cull pass over instance data: indices of the instances (count model matrices, strideFloats apart)
+// whose copy of the local sphere touches the frustum. Returns how many that is.
+inline size_t CullInstances(const Frustum& frustum, const BoundingSphere& local, const float* models, size_t count,
+                            size_t strideFloats, std::vector<int>& visible) {
+    visible.clear();
+    for (size_t i = 0; i < count; ++i) {
+        BoundingSphere world = TransformSphere(models + i * strideFloats, local);
+        if (frustum.IntersectsSphere(world.center, world.radius)) visible.push_back((int)i);
+    }
+    return visible.size();
+}
+
+// Drawn / culled objects (instances or single draws), for profiling. BeginFrame clears the last-frame numbers.
+class CullStats {
+	public:
+    static inline size_t drawn = 0, culled = 0;           // last frame
+    static inline size_t totalDrawn = 0, totalCulled = 0; // since startup
+
+    static void BeginFrame() { drawn = culled = 0; }
+    static void Count(size_t drawnCount, size_t culledCount) {
+        drawn += drawnCount; culled += culledCount;
+        totalDrawn += drawnCount; totalCulled += culledCount;
+    }
+    static void Print(std::ostream& out = std::cout) {
+        out << "Culling: last frame " << drawn << " drawn, " << culled << " culled; total " << totalDrawn
+            << " drawn, " << totalCulled << " culled\n";
+    }
+};
@@ -1,5 +1,10 @@
 #pragma once
 #include "Tetris.h"
+#include "UniformBlocks.h"
+#include "TransformStore.h"
+#include "Frustum.h"
+#include "CylinderLayout.h"
+#include "MeshRegistry.h"
 
 
 unsigned int tetrisAtlas;
@@ -68,7 +73,7 @@ const std::array<MinoUV, 9> MinoUVs{{
 }};
 
 
-std::array<Mesh, 9> MinoMeshes;  // index = Mino enum
+std::array<const Mesh*, 9> MinoMeshes;  // index = Mino enum, shared (MeshRegistry)
 /*
 void CreateAllMinoMeshes() {
     for (int i = 1; i <= 8; ++i) {
@@ -86,53 +91,66 @@ void CreateAllMinoMeshes() {
 void CreateAllMinoMeshes() {
     for (int i = 1; i <= 8; ++i) {
         auto uv = MinoUVs[i];
-        MinoMeshes[i] = CreateRubikCubieMesh(uv.uv, uv.uv, uv.uv, uv.uv, uv.uv, uv.uv);
-        MinoMeshes[i].Setup();
+        // Already uploaded by the generator (it calls Setup), nothing else to do
+        MinoMeshes[i] = &MeshRegistry::RubikCubie(uv.uv, uv.uv, uv.uv, uv.uv, uv.uv, uv.uv);
     }
 }
 
 
+// Uniform handles of the board program, looked up once when the renderer is created.
+// Camera and lighting are not here, they come from the shared uniform blocks (UniformBlocks.h).
+class TetrisUniforms {
+public:
+    Uniform<matrix4> model;
+    Uniform<matrix3> normalMatrix;
+    Uniform<int> mode;
+    Uniform<float> opacity;
+
+    void Lookup(const Shader& shader) {
+        model = shader.GetUniform<matrix4>("model");
+        normalMatrix = shader.GetUniform<matrix3>("normalMatrix");
+        mode = shader.GetUniform<int>("mode");
+        opacity = shader.GetUniform<float>("opacity");
+    }
+};
 
 class Cubies {
 public:
     int gridX, gridY;
     Mino type = Mino::Empty;
-    matrix4 modelMatrix;
-    float radius = 2.0f;
-    float size   = 1.0f;
+    int transform = -1; // handle into the group's TransformStore (model + normal matrix)
 
-    Cubies(int x, int y, Mino t, float r = 2.0f, float s = 1.0f)
-        : gridX(x), gridY(y), type(t), radius(r), size(s) {
-        UpdateModelMatrix();
+    Cubies(TransformStore& transforms, const CylinderLayout& layout, int x, int y, Mino t)
+        : gridX(x), gridY(y), type(t) {
+        transform = transforms.Create();
+        UpdateModelMatrix(transforms, layout);
     }
 
     // --- Fix for Game.h: Cubies::UpdateModelMatrix() ---
-void UpdateModelMatrix() {
-    // 1. Calculate cylindrical coordinates
-    float angle = (float(gridX) / BOARD_WIDTH) * 2.0f * PI;
-    float x = radius * cosf(angle);
-    float z = radius * sinf(angle);
-    float y = gridY * size;
+void UpdateModelMatrix(TransformStore& transforms, const CylinderLayout& layout) {
+    // 1. Cylindrical coordinates, from the per-column sin/cos table (no trig per block)
+    vec3 position = layout.Position(gridX, gridY);
 	
-    matrix4 translationMatrix;
-    translationMatrix.Translate(x, y, z); 
-
-    //matrix4 scaleMatrix;
-    //scaleMatrix.Scale(size * 0.98f, size * 0.98f, size * 0.98f);
-    // M_model = M_Translation * M_Scale
-	modelMatrix = translationMatrix;
-    //modelMatrix = translationMatrix * scaleMatrix;
-    // modelMatrix = translationMatrix * rotationMatrix * scaleMatrix;
+    // M_model = M_Translation (identity rotation in the store, so the normal matrix stays identity)
+    // A rotation facing the blocks outwards would go in through transforms.SetRotation.
+    transforms.SetPosition(transform, position);
+    transforms.Compose(transform);
 }
 
-    void Draw(const Shader& shader, bool ghost = false) const {
-        if (type == Mino::Empty) return;
+    // False when the block is outside the frustum (nothing submitted)
+    bool Draw(const Shader& shader, const TetrisUniforms& uniforms, const TransformStore& transforms, const Frustum& frustum,
+              bool ghost = false) const {
+        if (type == Mino::Empty) return false;
+        BoundingSphere world = TransformSphere(transforms.Model(transform), MinoMeshes[(int)type]->boundingSphere);
+        if (!frustum.IntersectsSphere(world.center, world.radius)) return false;
 
-        shader.setMat4("model", modelMatrix);
-        shader.setInt("mode", ghost ? 1 : 0);  // 0 = filled, 1 = yellow wireframe
+        shader.set(uniforms.model, transforms.Model(transform));
+        shader.set(uniforms.normalMatrix, transforms.NormalMatrix(transform));
+        shader.set(uniforms.mode, ghost ? 1 : 0);  // 0 = filled, 1 = yellow wireframe
 
-        glBindVertexArray(MinoMeshes[(int)type].VAO);
+        glBindVertexArray(MinoMeshes[(int)type]->VAO);
         glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        return true;
     }
 };
 
@@ -143,19 +161,39 @@ private:
     std::vector<Cubies> boardCubies;
     std::vector<Cubies> currentPieceCubies;
     std::vector<Cubies> ghostCubies;
+    // Their transforms, one store per group since each group is rebuilt on its own
+    TransformStore boardTransforms;
+    TransformStore pieceTransforms;
+    TransformStore ghostTransforms;
 
     float radius = 2.0f; //used to be 12, too much
     float blockSize = 1.0f;
+    CylinderLayout layout; // column positions for the current radius, rebuilt by SetRadius
 
 public:
     TetrisGame& game;
     Shader& shader; 
-	Mesh floorMesh;
+    TetrisUniforms uniforms;
+	const MeshLOD* floorLOD = nullptr; // shared unit circle (MeshRegistry); level picked per draw
+	affine floorModel; // scales the unit circle out to the radius, set by SetRadius
+	float floorScale = 1.0f;
+	// Small flat yellow sphere where the light is, in the middle of the cylinder
+	const MeshLOD* lightMarkerLOD = nullptr; // shared unit sphere (MeshRegistry); level picked per draw
+	vec3 lightPosition;
+	const float LIGHT_MARKER_RADIUS = 0.15f;
+	// Shared by every program: camera once per frame, lighting once at startup
+	UniformBuffer<FrameDataBlock> frameBuffer;
+	UniformBuffer<LightingBlock> lightingBuffer;
+	FrameDataBlock frameData;
 
     TetrisRenderer(TetrisGame& g, Shader& s) : game(g), shader(s) {
-        
+        uniforms.Lookup(shader);
+		frameBuffer.Setup(FRAME_DATA_BINDING);
+		lightingBuffer.Setup(LIGHTING_BINDING);
+		SetupLighting();
+		floorLOD = &MeshRegistry::CircleLOD(64);
+		lightMarkerLOD = &MeshRegistry::SphereLOD(12, 12);
 		SetRadius(radius);
-		floorMesh = CreateCircleMesh(radius + 0.6f, 64, -0.5f);
 		//RebuildBoard();
         //UpdateCurrentPiece();
         //UpdateGhost();
@@ -163,6 +201,13 @@ public:
 
     void SetRadius(float r) {
         radius = r;
+        layout.Set(BOARD_WIDTH, radius, blockSize);
+        // The floor reaches a bit past the blocks, just under them; no new mesh per radius
+        floorScale = radius + 0.6f;
+        affine lower, widen;
+        lower.Translate(0.0f, -0.5f, 0.0f);
+        widen.Scale(floorScale, 1.0f, floorScale);
+        floorModel = lower * widen;
         RebuildBoard();
         UpdateCurrentPiece();
         UpdateGhost();
@@ -170,11 +215,14 @@ public:
 
     void RebuildBoard() {
         boardCubies.clear();
+        boardTransforms.Clear();
+        boardCubies.reserve(BOARD_WIDTH * BOARD_HEIGHT);
+        boardTransforms.Reserve(BOARD_WIDTH * BOARD_HEIGHT);
         for (int y = 0; y < BOARD_HEIGHT; ++y) {
             for (int x = 0; x < BOARD_WIDTH; ++x) {
                 Mino m = game.board.getCell(x, y);
                 if (m != Mino::Empty) {
-                    boardCubies.emplace_back(x, y, m, radius, blockSize);
+                    boardCubies.emplace_back(boardTransforms, layout, x, y, m);
                 }
             }
         }
@@ -182,78 +230,102 @@ public:
 
     void UpdateCurrentPiece() {
         currentPieceCubies.clear();
+        pieceTransforms.Clear();
         for (auto [px, py] : game.current.minoPositions()) {
-            currentPieceCubies.emplace_back(px, py, game.current.type, radius, blockSize);
+            currentPieceCubies.emplace_back(pieceTransforms, layout, px, py, game.current.type);
         }
     }
 
     void UpdateGhost() {
         ghostCubies.clear();
+        ghostTransforms.Clear();
         Pieces ghost = game.current;
         while (game.board.canPlace(ghost)) ghost.y--;
         ghost.y++;  // one step above lock
 
         for (auto [px, py] : ghost.minoPositions()) {
-            ghostCubies.emplace_back(px, py, Mino::Ghost, radius, blockSize);
+            ghostCubies.emplace_back(ghostTransforms, layout, px, py, Mino::Ghost);
         }
     }
 
-    void Render(Camera& cam, const matrix4& projection) {
+    void SetupLighting() {
+		vec3 lightPos(0.0f, 0.0f, 0.0f); 
+		lightPosition = lightPos;
+		vec3 lightAmbient(0.4f, 0.4f, 0.4f);
+		vec3 lightDiffuse(0.70f, 0.70f, 0.70f);
+		vec3 lightSpecular(1.0f, 1.0f, 1.0f);
+		
+		vec3 materialSpecular(0.5f, 0.5f, 0.5f);
+		float materialShininess = 32.0f;
+
+        // Light (tweak to taste)
+		LightingBlock lighting;
+		lighting.SetLight(lightPos, lightAmbient, lightDiffuse, lightSpecular);
+		lighting.SetAttenuation(1.0f, 0.09f, 0.032f);
+		lighting.SetMaterial(materialSpecular, materialShininess);
+		lightingBuffer.Upload(lighting);
+    }
+
+    // viewportHeight: framebuffer height in pixels (level of detail of the floor)
+    void Render(Camera& cam, const matrix4& projection, float viewportHeight) {
         //glActiveTexture(GL_TEXTURE0);
         //glBindTexture(GL_TEXTURE_2D, tetrisAtlas);
 		
+		// Projection, view and camera position in one write
+		matrix4 view = cam.GetViewMatrix();
+		frameData.Set(projection, view, cam.Position);
+		frameBuffer.Upload(frameData);
+		Frustum frustum;
+		frustum.Extract(projection * view);
+		CullStats::BeginFrame();
+
 		shader.use();
-		shader.setMat4("projection", projection);
-		shader.setMat4("view", cam.GetViewMatrix());
 		//shader.setInt("mode", 0); // solid
 
 		// ---- Draw circular floor base ----
-		{
-			matrix4 floorModel;
-			floorModel.Identity();
-			shader.setMat4("model", floorModel);
-
+		const BoundingSphere& floorBounds = floorLOD->levels[0].mesh->boundingSphere;
+		vec3 floorCenter = floorModel.TransformPoint(floorBounds.center);
+		if (frustum.IntersectsSphere(floorCenter, floorBounds.radius * floorScale)) {
+			CullStats::Count(1, 0);
+			shader.set(uniforms.model, floorModel); // expanded to a mat4 by Shader::set
+			shader.set(uniforms.normalMatrix, floorModel.NormalMatrix());
+
+			// Fewer segments when the floor is small on screen
+			const Mesh& floorMesh = floorLOD->Select(projection, viewportHeight, cam.Position, floorCenter, floorScale);
 			glBindVertexArray(floorMesh.VAO);
 			glDrawElements(GL_TRIANGLES, floorMesh.indices.size(), GL_UNSIGNED_INT, 0);
+		} else {
+			CullStats::Count(0, 1);
 		}
 		// ---------------------------------
 
-		
-		
-		
-		vec3 lightPos(0.0f, 0.0f, 0.0f); 
-		vec3 lightAmbient(0.4f, 0.4f, 0.4f);
-		vec3 lightDiffuse(0.70f, 0.70f, 0.70f);
-		vec3 lightSpecular(1.0f, 1.0f, 1.0f);
-		
-		vec3 materialSpecular(0.5f, 0.5f, 0.5f);
-		float materialShininess = 32.0f;
-		
-        shader.use();
-		shader.setVec3("viewPos", cam.Position);
+		// ---- Light marker ----
+		if (frustum.IntersectsSphere(lightPosition, LIGHT_MARKER_RADIUS)) {
+			CullStats::Count(1, 0);
+			affine lightModel, markerScale;
+			lightModel.Translate(lightPosition);
+			markerScale.Scale(LIGHT_MARKER_RADIUS, LIGHT_MARKER_RADIUS, LIGHT_MARKER_RADIUS);
+			shader.set(uniforms.model, lightModel * markerScale);
+			shader.set(uniforms.normalMatrix, matrix3());
+			shader.set(uniforms.mode, 1); // flat yellow, unlit
+
+			// Fewer rings and meridians when the marker is small on screen
+			const Mesh& markerMesh = lightMarkerLOD->Select(projection, viewportHeight, cam.Position, lightPosition, LIGHT_MARKER_RADIUS);
+			glBindVertexArray(markerMesh.VAO);
+			glDrawElements(GL_TRIANGLES, markerMesh.indices.size(), GL_UNSIGNED_INT, 0);
+			shader.set(uniforms.mode, 0);
+		} else {
+			CullStats::Count(0, 1);
+		}
 
-        // Light (tweak to taste)
-        shader.setVec3("light.position", lightPos);
-        shader.setVec3("light.ambient",  lightAmbient);
-        shader.setVec3("light.diffuse",  lightDiffuse);
-        shader.setVec3("light.specular", lightSpecular);
-		
-		shader.setFloat("light.constant", 1.0f);
-		shader.setFloat("light.linear", 0.09f);
-		shader.setFloat("light.quadratic", 0.032f);
-		// Set Material
-		shader.setVec3("material.specular", materialSpecular);
-		shader.setFloat("material.shininess", materialShininess);
-		
 		float currentOpacity = 0.7f; // transparency
-		shader.setFloat("opacity", currentOpacity);
-		
-		shader.setMat4("projection", projection);
-        shader.setMat4("view", cam.GetViewMatrix());
-
-        // Draw order: board → ghost → current
-        for (auto& c : boardCubies)          c.Draw(shader, false);
-        for (auto& c : ghostCubies)          c.Draw(shader, true);   // yellow wireframe
-        for (auto& c : currentPieceCubies)   c.Draw(shader, false);
+		shader.set(uniforms.opacity, currentOpacity);
+
+        // Draw order: board → ghost → current. Blocks outside the view (e.g. behind the camera when zoomed in) are skipped.
+        size_t drawn = 0, total = boardCubies.size() + ghostCubies.size() + currentPieceCubies.size();
+        for (auto& c : boardCubies)          drawn += c.Draw(shader, uniforms, boardTransforms, frustum, false);
+        for (auto& c : ghostCubies)          drawn += c.Draw(shader, uniforms, ghostTransforms, frustum, true);   // yellow wireframe
+        for (auto& c : currentPieceCubies)   drawn += c.Draw(shader, uniforms, pieceTransforms, frustum, false);
+        CullStats::Count(drawn, total - drawn);
     }
 };
\ No newline at end of file
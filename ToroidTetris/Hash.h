@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a, 64 bit: small and good enough for cache keys and hash tables (not for anything adversarial).
+// Pass the previous result as seed to hash several pieces as one.
+const uint64_t FNV1A_OFFSET_BASIS = 14695981039346656037ull;
+
+inline uint64_t Fnv1a(const void* data, size_t bytes, uint64_t seed = FNV1A_OFFSET_BASIS) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t hash = seed;
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
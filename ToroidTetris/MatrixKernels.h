@@ -0,0 +1,209 @@
+#pragma once
+#include <cstddef>
+
+/*
+4x4 matrix kernels behind matrix4 (column-major float[16], like GL).
+ - SSE on x86 (x86-64 always has it; AVX builds use the same 4-wide code, VEX encoded)
+ - NEON on ARM
+ - plain scalar code everywhere else, or when MATRIX_NO_SIMD is defined
+A 4x4 column is exactly one 4-wide register, wider vectors (AVX 8-wide) would only help
+when transforming two points at once and are not worth a second code path.
+The *Scalar and *SIMD versions are always both there (SIMD = scalar without SIMD support),
+so bench/MatrixBench.cpp can compare them in one binary.
+Unaligned loads/stores everywhere: matrix4 is 16-byte aligned, but the kernels are also
+used on plain float arrays (instance buffers, vertex data).
+*/
+
+#if !defined(MATRIX_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define MATRIX_SIMD_SSE 1
+#include <xmmintrin.h>
+#elif !defined(MATRIX_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define MATRIX_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Name of the code path in use, for logs and the benchmark
+inline const char* MatrixKernelName() {
+#if defined(MATRIX_SIMD_SSE)
+    return "SSE";
+#elif defined(MATRIX_SIMD_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+// --- Scalar reference ---
+
+// out = a * b. out must not alias a or b.
+inline void Mat4MulScalar(const float* a, const float* b, float* out) {
+    for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 4; ++i)
+            out[i + j * 4] = a[i] * b[j * 4] + a[i + 4] * b[j * 4 + 1] + a[i + 8] * b[j * 4 + 2] + a[i + 12] * b[j * 4 + 3];
+}
+// out = m * (x, y, z, 1), all 4 components
+inline void Mat4TransformScalar(const float* m, float x, float y, float z, float out[4]) {
+    out[0] = m[0] * x + m[4] * y + m[8] * z + m[12];
+    out[1] = m[1] * x + m[5] * y + m[9] * z + m[13];
+    out[2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+    out[3] = m[3] * x + m[7] * y + m[11] * z + m[15];
+}
+
+// --- SIMD ---
+
+inline void Mat4MulSIMD(const float* a, const float* b, float* out) {
+#if defined(MATRIX_SIMD_SSE)
+    __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    for (int j = 0; j < 4; ++j) {
+        const float* bj = b + j * 4;
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bj[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bj[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bj[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bj[3])));
+        _mm_storeu_ps(out + j * 4, r);
+    }
+#elif defined(MATRIX_SIMD_NEON)
+    float32x4_t a0 = vld1q_f32(a), a1 = vld1q_f32(a + 4), a2 = vld1q_f32(a + 8), a3 = vld1q_f32(a + 12);
+    for (int j = 0; j < 4; ++j) {
+        const float* bj = b + j * 4;
+        float32x4_t r = vmulq_n_f32(a0, bj[0]);
+        r = vmlaq_n_f32(r, a1, bj[1]);
+        r = vmlaq_n_f32(r, a2, bj[2]);
+        r = vmlaq_n_f32(r, a3, bj[3]);
+        vst1q_f32(out + j * 4, r);
+    }
+#else
+    Mat4MulScalar(a, b, out);
+#endif
+}
+
+inline void Mat4TransformSIMD(const float* m, float x, float y, float z, float out[4]) {
+#if defined(MATRIX_SIMD_SSE)
+    __m128 r = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(x)), _mm_loadu_ps(m + 12));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(z)));
+    _mm_storeu_ps(out, r);
+#elif defined(MATRIX_SIMD_NEON)
+    float32x4_t r = vmlaq_n_f32(vld1q_f32(m + 12), vld1q_f32(m), x);
+    r = vmlaq_n_f32(r, vld1q_f32(m + 4), y);
+    r = vmlaq_n_f32(r, vld1q_f32(m + 8), z);
+    vst1q_f32(out, r);
+#else
+    Mat4TransformScalar(m, x, y, z, out);
+#endif
+}
+
+// --- Batches ---
+
+// Transform count packed xyz points (w = 1), in may equal out. Homogenizes only when w is not 1
+// (never for model matrices), so the usual case has no divide.
+inline void Mat4TransformPointsScalar(const float* m, const float* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float r[4];
+        Mat4TransformScalar(m, in[i * 3], in[i * 3 + 1], in[i * 3 + 2], r);
+        float s = (r[3] != 0.0f && r[3] != 1.0f) ? 1.0f / r[3] : 1.0f;
+        out[i * 3] = r[0] * s; out[i * 3 + 1] = r[1] * s; out[i * 3 + 2] = r[2] * s;
+    }
+}
+inline void Mat4TransformPointsSIMD(const float* m, const float* in, float* out, size_t count) {
+#if defined(MATRIX_SIMD_SSE)
+    __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+    for (size_t i = 0; i < count; ++i) {
+        const float* p = in + i * 3;
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p[0])), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+        alignas(16) float t[4];
+        _mm_store_ps(t, r);
+        float s = (t[3] != 0.0f && t[3] != 1.0f) ? 1.0f / t[3] : 1.0f;
+        // 3 floats per point: a 4-wide store would run past the end of the array
+        out[i * 3] = t[0] * s; out[i * 3 + 1] = t[1] * s; out[i * 3 + 2] = t[2] * s;
+    }
+#elif defined(MATRIX_SIMD_NEON)
+    float32x4_t c0 = vld1q_f32(m), c1 = vld1q_f32(m + 4), c2 = vld1q_f32(m + 8), c3 = vld1q_f32(m + 12);
+    for (size_t i = 0; i < count; ++i) {
+        const float* p = in + i * 3;
+        float32x4_t r = vmlaq_n_f32(c3, c0, p[0]);
+        r = vmlaq_n_f32(r, c1, p[1]);
+        r = vmlaq_n_f32(r, c2, p[2]);
+        float t[4];
+        vst1q_f32(t, r);
+        float s = (t[3] != 0.0f && t[3] != 1.0f) ? 1.0f / t[3] : 1.0f;
+        out[i * 3] = t[0] * s; out[i * 3 + 1] = t[1] * s; out[i * 3 + 2] = t[2] * s;
+    }
+#else
+    Mat4TransformPointsScalar(m, in, out, count);
+#endif
+}
+// Interleaved vertices (Mesh layout: pos3 uv2 normal3, stride 8): count vertices of stride floats,
+// position at offset 0 goes through m (w = 1, no homogenize: model matrices only), the normal at
+// normalOffset through the upper 3x3 of normalMatrix (w = 0). normalMatrix null = normals untouched.
+// Everything else (UVs) is copied when src != dst; src == dst transforms in place.
+// dst can be a mapped GL buffer, it is only ever written, one float at a time (no read-back).
+inline void Mat4TransformVerticesScalar(const float* m, const float* normalMatrix, const float* src, float* dst,
+                                        size_t count, size_t stride, size_t normalOffset) {
+    for (size_t i = 0; i < count; ++i, src += stride, dst += stride) {
+        float p[3] = { src[0], src[1], src[2] }, n[3] = { 0.0f, 0.0f, 0.0f };
+        if (normalMatrix) { n[0] = src[normalOffset]; n[1] = src[normalOffset + 1]; n[2] = src[normalOffset + 2]; }
+        if (src != dst)
+            for (size_t k = 3; k < stride; ++k) dst[k] = src[k];
+        for (int r = 0; r < 3; ++r) dst[r] = m[r] * p[0] + m[r + 4] * p[1] + m[r + 8] * p[2] + m[r + 12];
+        if (normalMatrix)
+            for (int r = 0; r < 3; ++r)
+                dst[normalOffset + r] = normalMatrix[r] * n[0] + normalMatrix[r + 4] * n[1] + normalMatrix[r + 8] * n[2];
+    }
+}
+inline void Mat4TransformVerticesSIMD(const float* m, const float* normalMatrix, const float* src, float* dst,
+                                      size_t count, size_t stride, size_t normalOffset) {
+#if defined(MATRIX_SIMD_SSE) || defined(MATRIX_SIMD_NEON)
+#if defined(MATRIX_SIMD_SSE)
+    __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+    __m128 n0 = c0, n1 = c1, n2 = c2;
+    if (normalMatrix) { n0 = _mm_loadu_ps(normalMatrix); n1 = _mm_loadu_ps(normalMatrix + 4); n2 = _mm_loadu_ps(normalMatrix + 8); }
+#else
+    float32x4_t c0 = vld1q_f32(m), c1 = vld1q_f32(m + 4), c2 = vld1q_f32(m + 8), c3 = vld1q_f32(m + 12);
+    float32x4_t n0 = c0, n1 = c1, n2 = c2;
+    if (normalMatrix) { n0 = vld1q_f32(normalMatrix); n1 = vld1q_f32(normalMatrix + 4); n2 = vld1q_f32(normalMatrix + 8); }
+#endif
+    for (size_t i = 0; i < count; ++i, src += stride, dst += stride) {
+        alignas(16) float p[4], n[4];
+#if defined(MATRIX_SIMD_SSE)
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src[0])), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(src[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(src[2])));
+        _mm_store_ps(p, r);
+        if (normalMatrix) {
+            const float* s = src + normalOffset;
+            __m128 q = _mm_mul_ps(n0, _mm_set1_ps(s[0]));
+            q = _mm_add_ps(q, _mm_mul_ps(n1, _mm_set1_ps(s[1])));
+            q = _mm_add_ps(q, _mm_mul_ps(n2, _mm_set1_ps(s[2])));
+            _mm_store_ps(n, q);
+        }
+#else
+        float32x4_t r = vmlaq_n_f32(c3, c0, src[0]);
+        r = vmlaq_n_f32(r, c1, src[1]);
+        r = vmlaq_n_f32(r, c2, src[2]);
+        vst1q_f32(p, r);
+        if (normalMatrix) {
+            const float* s = src + normalOffset;
+            float32x4_t q = vmulq_n_f32(n0, s[0]);
+            q = vmlaq_n_f32(q, n1, s[1]);
+            q = vmlaq_n_f32(q, n2, s[2]);
+            vst1q_f32(n, q);
+        }
+#endif
+        // Both results are in registers before anything is written, so src == dst is fine.
+        // 3-float stores: a 4-wide one would spill into the next attribute.
+        if (src != dst)
+            for (size_t k = 3; k < stride; ++k) dst[k] = src[k];
+        dst[0] = p[0]; dst[1] = p[1]; dst[2] = p[2];
+        if (normalMatrix) { dst[normalOffset] = n[0]; dst[normalOffset + 1] = n[1]; dst[normalOffset + 2] = n[2]; }
+    }
+#else
+    Mat4TransformVerticesScalar(m, normalMatrix, src, dst, count, stride, normalOffset);
+#endif
+}
+// out[i] = a * b[i] for count matrices (per-instance model matrices and the like)
+inline void Mat4MulBatch(const float* a, const float* b, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) Mat4MulSIMD(a, b + i * 16, out + i * 16);
+}
@@ -2,10 +2,11 @@
 #include <cmath>
 #include <vector>
 #include <iostream>
+#include "MatrixKernels.h"
 class vec3 {
 	public:
     float x, y, z;
-    vec3(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+    constexpr vec3(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
 	float length() const { return std::sqrt(x * x + y * y + z * z); }
     //Helper functions
 	vec3 normalize() const {
@@ -13,35 +14,49 @@ class vec3 {
         if (len > 1e-6f) return vec3(x / len, y / len, z / len);
         return vec3(0, 0, 0);
     }
-    vec3 cross(const vec3& other) const {
+    constexpr vec3 cross(const vec3& other) const {
         return vec3(y * other.z - z * other.y,
                     z * other.x - x * other.z,
                     x * other.y - y * other.x);
     }
-    vec3 operator-(const vec3& other) const {
+    constexpr vec3 operator-(const vec3& other) const {
         return vec3(x - other.x, y - other.y, z - other.z);
     }
-	vec3 operator+(const vec3& other) const {
+	constexpr vec3 operator+(const vec3& other) const {
         return vec3(x + other.x, y + other.y, z + other.z);
     }
-    vec3 operator-() const {
+    constexpr vec3 operator-() const {
         return vec3(-x, -y, -z);
     }
-	bool operator<(const vec3& other) const {
+	constexpr bool operator<(const vec3& other) const {
 		if (x != other.x) return x < other.x;
 		if (y != other.y) return y < other.y;
 		return z < other.z;
 	}
 };
+// cos / sin of quarters * 90 degrees, exact: quarter turns need no trig (and get 0, not -4.4e-8)
+constexpr int QuarterCos(int quarters) {
+    constexpr int values[4] = { 1, 0, -1, 0 };
+    return values[((quarters % 4) + 4) % 4];
+}
+constexpr int QuarterSin(int quarters) { return QuarterCos(quarters - 1); }
+
+// 3x3, column-major like matrix4. Only used for normal matrices (glUniformMatrix3fv).
+class matrix3 {
+	public:
+    float m[9] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+};
+
 class matrix4 {
 	public:
-    float m[16];
+    alignas(16) float m[16]; // one SIMD register per column (MatrixKernels.h)
 
-    matrix4() {
-        Identity();
-    }
+    constexpr matrix4() : m{ 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } {}
+    // Leaves m uninitialized, for results that are written in full right away
+    struct NoInit {};
+    explicit matrix4(NoInit) {}
 
-    void Identity() {
+    constexpr void Identity() {
         for (int i = 0; i < 16; ++i)
             m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
     }
@@ -70,6 +85,15 @@ class matrix4 {
 		m[4] = -sinA;  m[5] = cosA;
 	}
 	
+	// Exact quarters * 90 degrees around axis 0 X, 1 Y, 2 Z, same sense as RotateX/Y/Z. Constant-evaluable.
+	constexpr void QuarterTurn(int axis, int quarters) {
+		float c = (float)QuarterCos(quarters), s = (float)QuarterSin(quarters);
+		Identity();
+		int a = (axis + 1) % 3, b = (axis + 2) % 3; // the plane that turns: X -> y,z  Y -> z,x  Z -> x,y
+		m[a * 4 + a] = c; m[a * 4 + b] = s;
+		m[b * 4 + a] = -s; m[b * 4 + b] = c;
+	}
+	
 	void Rotate(char axis, float angle) {
 		switch (axis) {
 			case 'x': case 'X': RotateX(angle); break;
@@ -79,20 +103,20 @@ class matrix4 {
 		}
 	}
 	
-    void Scale(float sx, float sy, float sz) {
+    constexpr void Scale(float sx, float sy, float sz) {
         Identity();
         m[0] = sx; m[5] = sy; m[10] = sz;
     }
 
-    void Translate(float tx, float ty, float tz) {
+    constexpr void Translate(float tx, float ty, float tz) {
         Identity();
         m[12] = tx; m[13] = ty; m[14] = tz;
     }
-	void Translate(const vec3& v) {
+	constexpr void Translate(const vec3& v) {
 		Translate(v.x, v.y, v.z);
 		}
 
-	void InverseTranslate(float tx, float ty, float tz) {
+	constexpr void InverseTranslate(float tx, float ty, float tz) {
 		Identity();
 		m[12] = -tx;
 		m[13] = -ty;
@@ -111,22 +135,16 @@ class matrix4 {
 	void InverseRotateZ(float angle) { RotateZ(-angle); }
 
     matrix4 operator*(const matrix4& other) const {
-        matrix4 result;
-        for (int i = 0; i < 4; ++i)
-            for (int j = 0; j < 4; ++j) {
-                result.m[i + j * 4] = 0.0f;
-                for (int k = 0; k < 4; ++k)
-                    result.m[i + j * 4] += m[i + k * 4] * other.m[k + j * 4];
-            }
+        matrix4 result{ NoInit() };
+        Mat4MulSIMD(m, other.m, result.m);
         return result;
     }
 	// Matrix-vector multiplication (column-major order)
 	void multVect(const float m[16], float& x, float& y, float& z)
 	{
-		float tx = m[0]*x + m[4]*y + m[8]*z + m[12];  // x
-		float ty = m[1]*x + m[5]*y + m[9]*z + m[13];  // y
-		float tz = m[2]*x + m[6]*y + m[10]*z + m[14]; // z
-		float tw = m[3]*x + m[7]*y + m[11]*z + m[15]; // w
+		float t[4];
+		Mat4TransformSIMD(m, x, y, z, t);
+		float tx = t[0], ty = t[1], tz = t[2], tw = t[3];
 
 		//Homogenize if w != 1
 		if (tw != 0.0f && tw != 1.0f) {
@@ -139,6 +157,7 @@ class matrix4 {
 		y = ty;
 		z = tz;
 	}
+	// Assumes an affine matrix (ignores the bottom row, so not for projections); affine::Invert is the same without the padding
 	bool Invert()
 	{
 		matrix4 inv;
@@ -183,15 +202,36 @@ class matrix4 {
 		*this = inv;
 		return true;
 	}
-	
-	void TransformVertices(std::vector<float>& vert) {
-    
-		for (size_t i = 0; i < vert.size(); i += 5) {
-			float& x = vert[i];
-			float& y = vert[i + 1];
-			float& z = vert[i + 2];
-			multVect(m, x, y, z);
+	// Normal matrix = transpose(inverse(upper 3x3)). Compute it once per object on the CPU
+	// instead of inverse() per vertex in the shader. For rotation + translation it is the upper 3x3 itself.
+	matrix3 NormalMatrix() const {
+		matrix3 n;
+		matrix4 inv = *this;
+		if (!inv.Invert()) {
+			for (int c = 0; c < 3; ++c)
+				for (int r = 0; r < 3; ++r) n.m[c * 3 + r] = m[c * 4 + r];
+			return n;
 		}
+		// n(row r, col c) = inv(row c, col r)
+		for (int c = 0; c < 3; ++c)
+			for (int r = 0; r < 3; ++r) n.m[c * 3 + r] = inv.m[r * 4 + c];
+		return n;
+	}
+	// NormalMatrix in the upper 3x3 of a matrix4, the layout the vertex kernels read (4 floats per column)
+	matrix4 NormalMatrix4() const {
+		matrix3 n = NormalMatrix();
+		matrix4 out;
+		for (int c = 0; c < 3; ++c)
+			for (int r = 0; r < 3; ++r) out.m[c * 4 + r] = n.m[c * 3 + r];
+		return out;
+	}
+	
+	// In place, interleaved vertices. Defaults to the Mesh layout (8 floats, normal at 5);
+	// normalOffset < 0 only moves positions (e.g. pos3 + uv2 data, stride 5).
+	void TransformVertices(std::vector<float>& vert, size_t stride = 8, int normalOffset = 5) {
+		matrix4 normal = NormalMatrix4();
+		Mat4TransformVerticesSIMD(m, normalOffset >= 0 ? normal.m : nullptr, vert.data(), vert.data(),
+		                          vert.size() / stride, stride, normalOffset >= 0 ? (size_t)normalOffset : 0);
 	}
 
     void PrintMatrix() const {
@@ -332,4 +372,206 @@ Perspective():
 		m[15] = 1.0f;
 	}
 	
+};
+
+// Unit quaternion, rotation only. Interpolates a turn by its angle without piling up matrix products.
+class quat {
+	public:
+    float w = 1.0f, x = 0.0f, y = 0.0f, z = 0.0f;
+
+    quat() {}
+    quat(float w, float x, float y, float z) : w(w), x(x), y(y), z(z) {}
+    // Right-handed rotation of angle radians around a unit axis (same sense as matrix4::RotateX/Y/Z)
+    static quat AxisAngle(const vec3& axis, float angle) {
+        float s = std::sin(angle * 0.5f);
+        return quat(std::cos(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s);
+    }
+    quat operator*(const quat& o) const {
+        return quat(w * o.w - x * o.x - y * o.y - z * o.z,
+                    w * o.x + x * o.w + y * o.z - z * o.y,
+                    w * o.y - x * o.z + y * o.w + z * o.x,
+                    w * o.z + x * o.y - y * o.x + z * o.w);
+    }
+    // Same rotation as a column-major 3x3
+    matrix3 ToMatrix() const {
+        matrix3 r;
+        r.m[0] = 1.0f - 2.0f * (y * y + z * z); r.m[3] = 2.0f * (x * y - w * z);        r.m[6] = 2.0f * (x * z + w * y);
+        r.m[1] = 2.0f * (x * y + w * z);        r.m[4] = 1.0f - 2.0f * (x * x + z * z); r.m[7] = 2.0f * (y * z - w * x);
+        r.m[2] = 2.0f * (x * z - w * y);        r.m[5] = 2.0f * (y * z + w * x);        r.m[8] = 1.0f - 2.0f * (x * x + y * y);
+        return r;
+    }
+    matrix4 ToMatrix4() const {
+        matrix3 r = ToMatrix();
+        matrix4 out;
+        for (int c = 0; c < 3; ++c)
+            for (int row = 0; row < 3; ++row) out.m[c * 4 + row] = r.m[c * 3 + row];
+        return out;
+    }
+};
+
+/*
+Affine transform as a 3x4 matrix: rotation/scale (3x3) + translation, the implied last row is 0 0 0 1.
+Everything the scene builds is affine (Translate, Rotate*, Scale, the cubie and sticker transforms),
+so the bottom row of a matrix4 is dead weight:
+ - compose: 36 mul + 27 add, a matrix4 multiply is 64 + 48
+ - point: 9 mul + 9 add, no w and no homogenize
+ - inverse: 3x3 inverse + one rotated translation, and exact for any affine input
+Kept on the CPU side; ToMatrix4 expands it only where a mat4 goes to the GPU (uniforms, instance buffers).
+Column-major like matrix4: column c is m[c * 3 .. c * 3 + 2], the translation is m[9..11].
+*/
+class affine {
+	public:
+    float m[12] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+
+    constexpr affine() {}
+    // Drops the bottom row, only meaningful for affine input (not projections)
+    constexpr explicit affine(const matrix4& a) {
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 3; ++r) m[c * 3 + r] = a.m[c * 4 + r];
+    }
+
+    constexpr void Identity() { *this = affine(); }
+//--- Transformations (same conventions as matrix4: each one replaces the matrix) ---
+    constexpr void Translate(float tx, float ty, float tz) {
+        Identity();
+        m[9] = tx; m[10] = ty; m[11] = tz;
+    }
+    constexpr void Translate(const vec3& v) { Translate(v.x, v.y, v.z); }
+    constexpr void Scale(float sx, float sy, float sz) {
+        Identity();
+        m[0] = sx; m[4] = sy; m[8] = sz;
+    }
+    void RotateX(float angle) {
+        float c = std::cos(angle), s = std::sin(angle);
+        Identity();
+        m[4] = c; m[5] = s;
+        m[7] = -s; m[8] = c;
+    }
+    void RotateY(float angle) {
+        float c = std::cos(angle), s = std::sin(angle);
+        Identity();
+        m[0] = c; m[2] = -s;
+        m[6] = s; m[8] = c;
+    }
+    void RotateZ(float angle) {
+        float c = std::cos(angle), s = std::sin(angle);
+        Identity();
+        m[0] = c; m[1] = s;
+        m[3] = -s; m[4] = c;
+    }
+    // Exact quarters * 90 degrees, see matrix4::QuarterTurn
+    constexpr void QuarterTurn(int axis, int quarters) {
+        float c = (float)QuarterCos(quarters), s = (float)QuarterSin(quarters);
+        Identity();
+        int a = (axis + 1) % 3, b = (axis + 2) % 3;
+        m[a * 3 + a] = c; m[a * 3 + b] = s;
+        m[b * 3 + a] = -s; m[b * 3 + b] = c;
+    }
+    // Column-major 3x3 + translation
+    constexpr void Set(const matrix3& linear, const vec3& t) {
+        for (int k = 0; k < 9; ++k) m[k] = linear.m[k];
+        m[9] = t.x; m[10] = t.y; m[11] = t.z;
+    }
+
+    // this * o: o first, then this
+    constexpr affine operator*(const affine& o) const {
+        affine r;
+        for (int c = 0; c < 4; ++c) {
+            const float* oc = o.m + c * 3;
+            for (int row = 0; row < 3; ++row)
+                r.m[c * 3 + row] = m[row] * oc[0] + m[3 + row] * oc[1] + m[6 + row] * oc[2];
+        }
+        r.m[9] += m[9]; r.m[10] += m[10]; r.m[11] += m[11];
+        return r;
+    }
+
+    constexpr vec3 TransformPoint(const vec3& p) const {
+        return vec3(m[0] * p.x + m[3] * p.y + m[6] * p.z + m[9],
+                    m[1] * p.x + m[4] * p.y + m[7] * p.z + m[10],
+                    m[2] * p.x + m[5] * p.y + m[8] * p.z + m[11]);
+    }
+    // Directions: no translation
+    constexpr vec3 TransformVector(const vec3& v) const {
+        return vec3(m[0] * v.x + m[3] * v.y + m[6] * v.z,
+                    m[1] * v.x + m[4] * v.y + m[7] * v.z,
+                    m[2] * v.x + m[5] * v.y + m[8] * v.z);
+    }
+    vec3 TransformNormal(const vec3& n) const {
+        matrix3 nm = NormalMatrix();
+        return vec3(nm.m[0] * n.x + nm.m[3] * n.y + nm.m[6] * n.z,
+                    nm.m[1] * n.x + nm.m[4] * n.y + nm.m[7] * n.z,
+                    nm.m[2] * n.x + nm.m[5] * n.y + nm.m[8] * n.z);
+    }
+
+    // General affine inverse. False (and unchanged) when the 3x3 part is singular.
+    bool Invert() {
+        float inv[9];
+        if (!Inverse3x3(inv)) {
+            std::cerr << "affine not invertible (det ~ 0)\n";
+            return false;
+        }
+        float tx = m[9], ty = m[10], tz = m[11];
+        for (int k = 0; k < 9; ++k) m[k] = inv[k];
+        m[9]  = -(inv[0] * tx + inv[3] * ty + inv[6] * tz);
+        m[10] = -(inv[1] * tx + inv[4] * ty + inv[7] * tz);
+        m[11] = -(inv[2] * tx + inv[5] * ty + inv[8] * tz);
+        return true;
+    }
+    // Rotation + translation only (LookAt, cubies): the inverse rotation is the transpose
+    constexpr affine InverseRigid() const {
+        affine r;
+        for (int c = 0; c < 3; ++c)
+            for (int row = 0; row < 3; ++row) r.m[c * 3 + row] = m[row * 3 + c];
+        r.m[9]  = -(r.m[0] * m[9] + r.m[3] * m[10] + r.m[6] * m[11]);
+        r.m[10] = -(r.m[1] * m[9] + r.m[4] * m[10] + r.m[7] * m[11]);
+        r.m[11] = -(r.m[2] * m[9] + r.m[5] * m[10] + r.m[8] * m[11]);
+        return r;
+    }
+    // transpose(inverse(3x3)), same as matrix4::NormalMatrix; the 3x3 itself when singular
+    matrix3 NormalMatrix() const {
+        matrix3 n;
+        float inv[9];
+        if (!Inverse3x3(inv)) {
+            for (int k = 0; k < 9; ++k) n.m[k] = m[k];
+            return n;
+        }
+        for (int c = 0; c < 3; ++c)
+            for (int row = 0; row < 3; ++row) n.m[c * 3 + row] = inv[row * 3 + c];
+        return n;
+    }
+
+    // The GPU boundary: full column-major mat4, straight into a uniform or instance buffer
+    constexpr void ToMatrix4(float out[16]) const {
+        for (int c = 0; c < 4; ++c) {
+            out[c * 4] = m[c * 3]; out[c * 4 + 1] = m[c * 3 + 1]; out[c * 4 + 2] = m[c * 3 + 2];
+            out[c * 4 + 3] = 0.0f;
+        }
+        out[15] = 1.0f;
+    }
+    matrix4 ToMatrix4() const {
+        matrix4 r{ matrix4::NoInit() };
+        ToMatrix4(r.m);
+        return r;
+    }
+
+private:
+    // Column-major inverse of the 3x3 part, by cofactors
+    bool Inverse3x3(float inv[9]) const {
+        float c00 = m[4] * m[8] - m[7] * m[5];
+        float c01 = m[7] * m[2] - m[1] * m[8];
+        float c02 = m[1] * m[5] - m[4] * m[2];
+        float det = m[0] * c00 + m[3] * c01 + m[6] * c02;
+        if (std::fabs(det) < 1e-6f) return false;
+        float s = 1.0f / det;
+        inv[0] = c00 * s;
+        inv[1] = c01 * s;
+        inv[2] = c02 * s;
+        inv[3] = (m[6] * m[5] - m[3] * m[8]) * s;
+        inv[4] = (m[0] * m[8] - m[6] * m[2]) * s;
+        inv[5] = (m[3] * m[2] - m[0] * m[5]) * s;
+        inv[6] = (m[3] * m[7] - m[6] * m[4]) * s;
+        inv[7] = (m[6] * m[1] - m[0] * m[7]) * s;
+        inv[8] = (m[0] * m[4] - m[3] * m[1]) * s;
+        return true;
+    }
 };
\ No newline at end of file
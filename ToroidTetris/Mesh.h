@@ -9,6 +9,8 @@
 #include <vector>
 #include <array>
 #include "MatrixOperations.h"
+#include "Bounds.h"
+#include "MeshOptimize.h"
 const float PI = 3.14159265359f;
 
 class Mesh {
@@ -16,8 +18,14 @@ public:
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
     unsigned int VAO, VBO, EBO;
+	// Interleaved vertex layout: position 3, texCoord 2, normal 3
+	static const size_t VERTEX_STRIDE = 8;
+	static const size_t NORMAL_OFFSET = 5;
 	vec3 center; 
 	matrix4 modelMatrix;
+	// Local-space bounds of the vertices, filled by Setup (for frustum culling, Frustum.h)
+	AABB bounds;
+	BoundingSphere boundingSphere;
 	
 	Mesh() : VAO(0), VBO(0), EBO(0), center(0,0,0) {
         modelMatrix.Identity();
@@ -29,7 +37,13 @@ public:
 	void Initialize() {
 		modelMatrix.Translate(center.x, center.y, center.z);
 	}
+	// Weld, drop degenerate triangles and reorder for the vertex cache (MeshOptimize.h), before Setup.
+	// name = line in the MeshOptimizeStats report (ACMR before/after).
+	void Optimize(const char* name) {
+		OptimizeMesh(vertices, indices, VERTEX_STRIDE, name);
+	}
 	void Setup(){
+        ComputeBounds(vertices, VERTEX_STRIDE, bounds, boundingSphere);
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
@@ -38,25 +52,42 @@ public:
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-		
-		const int stride = 8*sizeof(float);
-			//Adding Textures. Position = location 0 (3 floats), texCoord = location 1 (2 floats). Stride = 5 floats.
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0); // Position
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float))); // TexCoord
-			glEnableVertexAttribArray(1);	
-			//Normal Vector = location 2 (3 floats)
-			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float))); 
-			glEnableVertexAttribArray(2);
+		SetupAttributes();
         glBindVertexArray(0);
     }
-    void UpdateVertices(const matrix4& model) {
-		std::vector<float> transformed = vertices;
-		matrix4 final = model;
-		final.TransformVertices(transformed);
+	// Another VAO over this mesh's buffers, for a renderer that adds its own per-instance
+	// attributes to a shared mesh (MeshRegistry) without changing the mesh's own VAO.
+	unsigned int CreateVertexArray() const {
+		unsigned int vao = 0;
+		glGenVertexArrays(1, &vao);
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		SetupAttributes();
+		glBindVertexArray(0);
+		return vao;
+	}
+	// Uploads vertices transformed by model (positions, and normals by its normal matrix) for
+	// meshes that are moved on the CPU. Writes straight into the mapped VBO: no copy of vertices,
+	// no heap allocation, so it can run every frame. INVALIDATE lets the driver hand out fresh
+	// memory instead of waiting for draws still reading the old contents.
+	void UpdateVertices(const matrix4& model) {
+		const size_t count = vertices.size() / VERTEX_STRIDE;
+		const size_t bytes = vertices.size() * sizeof(float);
+		if (count == 0) return;
+		matrix4 normal = model.NormalMatrix4();
 
 		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, transformed.size() * sizeof(float), transformed.data());
+		float* mapped = (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (mapped) {
+			Mat4TransformVerticesSIMD(model.m, normal.m, vertices.data(), mapped, count, VERTEX_STRIDE, NORMAL_OFFSET);
+			if (glUnmapBuffer(GL_ARRAY_BUFFER)) return;
+			// GL_FALSE = contents lost (rare, e.g. display mode change), upload them again below
+		}
+		// Fallback: a staging copy that keeps its capacity, so this path also allocates only once
+		staging.resize(vertices.size());
+		Mat4TransformVerticesSIMD(model.m, normal.m, vertices.data(), staging.data(), count, VERTEX_STRIDE, NORMAL_OFFSET);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, staging.data());
 	}
 	
 	void Draw(unsigned int shaderProgram){
@@ -92,6 +123,20 @@ public:
 		return T2 * transform * T1;
 	}
 
+private:
+	// Vertex layout of the bound VAO, from the bound VBO
+	static void SetupAttributes() {
+		const int stride = VERTEX_STRIDE * sizeof(float);
+			//Adding Textures. Position = location 0 (3 floats), texCoord = location 1 (2 floats). Stride = 5 floats.
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0); // Position
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float))); // TexCoord
+			glEnableVertexAttribArray(1);	
+			//Normal Vector = location 2 (3 floats)
+			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float))); 
+			glEnableVertexAttribArray(2);
+	}
+	std::vector<float> staging; // UpdateVertices fallback when the VBO cannot be mapped
 };
 
 //Primitives - (Spawn position/local axis) as parameter
@@ -184,6 +229,7 @@ static Mesh CreateCube(float cx = 0.0f, float cy = 0.0f, float cz = 0.0f) {
     };
 
     Mesh cube(vertices, indices, vec3(cx, cy, cz));
+    cube.Optimize("cube");
     cube.Setup();
     return cube;
 }
@@ -323,6 +369,7 @@ static Mesh CreateRubikCubieMesh(
     };
 
     Mesh cube(vertices, indices, vec3(cx, cy, cz));
+    cube.Optimize("cubie");
     cube.Setup();
     return cube;
 }
@@ -363,10 +410,78 @@ static Mesh CreateCircleMesh(float radius = 5.0f, int segments = 64, float y = 0
     }
 
     Mesh circle(verts, inds);
+    circle.Optimize("floor");
     circle.Setup();
     return circle;
 }
 
+//UV Sphere(rings (longitude/slices) and stacks(latitude/segment))
+//12*12 by default
+static Mesh CreateSphere(float cx = 0.0f, float cy = 0.0f, float cz = 0.0f, float radius = 0.5f, int stacks = 12, int slices = 12) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+
+    // The two poles are special cases
+    for (int i = 0; i <= stacks; ++i) {
+        float V = (float)i / stacks;             // v (texture coord) from 0 to 1
+        float phi = V * PI;                      // Angle phi (latitude) from 0 to PI
+        // Exactly 0 at the poles (sin(PI) in float is not), so the pole triangles are found degenerate
+        float sinPhi = (i == 0 || i == stacks) ? 0.0f : std::sin(phi);
+
+        for (int j = 0; j <= slices; ++j) {
+            float U = (float)j / slices;         // u (texture coord) from 0 to 1
+            float theta = U * 2.0f * PI;         // Angle theta (longitude) from 0 to 2PI
+            // Spherical to Cartesian coordinates
+            float nx = sinPhi * std::cos(theta);
+            float ny = std::cos(phi);
+            float nz = sinPhi * std::sin(theta);
+            float x = radius * nx;
+            float y = radius * ny;
+            float z = radius * nz;
+
+            // Position (x, y, z)
+            vertices.push_back(x);
+            vertices.push_back(y);
+            vertices.push_back(z);
+            
+            // Texture Coords (u, v)
+            vertices.push_back(U);
+            vertices.push_back(V);
+
+            // Normal (the unit direction)
+            vertices.push_back(nx);
+            vertices.push_back(ny);
+            vertices.push_back(nz);
+        }
+    }
+
+    // Index calculation for a grid of quads (two triangles)
+    for (int i = 0; i < stacks; ++i) {
+        for (int j = 0; j < slices; ++j) {
+            unsigned int p1 = i * (slices + 1) + j;
+            unsigned int p2 = p1 + (slices + 1);
+            unsigned int p3 = p2 + 1;
+            unsigned int p4 = p1 + 1;
+			//Triangles order
+            // First triangle (quad's bottom-left)
+            indices.push_back(p1);
+            indices.push_back(p2);
+            indices.push_back(p4);
+
+            // Second triangle (quad's top-right)
+            indices.push_back(p4);
+            indices.push_back(p2);
+            indices.push_back(p3);
+        }
+    }
+
+    Mesh sphere(vertices, indices, vec3(cx, cy, cz));
+    sphere.Optimize("sphere");
+    sphere.Setup();
+    return sphere;
+}
+
+
 
 //How to call? 
 //Mesh cube = CreateCube(1.0f, 0.0f, -2.0f);
@@ -0,0 +1,251 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include "Hash.h"
+
+/*
+Post-processing of generated meshes (indexed triangles, interleaved float vertices), run once
+before the upload (Mesh::Optimize):
+ - WeldVertices: vertices identical in every attribute become one
+ - RemoveDegenerateTriangles: triangles with two corners at the same position (the poles of a UV sphere)
+ - OptimizeVertexCache: triangle order for the post-transform vertex cache (Forsyth's linear-speed
+   algorithm), so a vertex shared by several triangles is shaded once instead of once per triangle
+ - OptimizeVertexFetch: vertices renumbered in first-use order, so the vertex buffer is read front to back
+ACMR (average cache miss ratio) = vertex shader runs per triangle, from a FIFO cache simulation:
+3.0 means no reuse at all, about 0.6 is as good as a regular grid gets.
+*/
+
+// Vertex cache the triangle order is tuned for (Forsyth's model, LRU) and the one ACMR is measured with (FIFO)
+const int VERTEX_CACHE_MODEL_SIZE = 32;
+const int VERTEX_CACHE_MEASURE_SIZE = 16;
+
+// Vertex shader runs per triangle for this index order, with a FIFO cache of cacheSize vertices
+inline float ComputeACMR(const std::vector<unsigned int>& indices, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_MEASURE_SIZE) {
+    if (indices.size() < 3) return 0.0f;
+    // A vertex is cached while fewer than cacheSize misses happened since its own miss
+    std::vector<size_t> missedAt(vertexCount, 0);
+    size_t misses = 0, clock = cacheSize + 1;
+    for (unsigned int index : indices) {
+        if (clock - missedAt[index] > cacheSize) {
+            missedAt[index] = clock++;
+            ++misses;
+        }
+    }
+    return (float)misses / (float)(indices.size() / 3);
+}
+
+// Merges vertices whose stride floats are identical and remaps the indices.
+// Returns how many vertices were removed.
+inline size_t WeldVertices(std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t stride) {
+    const size_t count = vertices.size() / stride;
+    if (count < 2) return 0;
+    // -0 and +0 are the same value but not the same bits (sin/cos give both), make them all +0
+    for (float& f : vertices)
+        if (f == 0.0f) f = 0.0f;
+    const size_t bytes = stride * sizeof(float);
+    // Open addressing table of kept vertices (index + 1, 0 = empty), at most half full
+    size_t tableSize = 1;
+    while (tableSize < count * 2) tableSize <<= 1;
+    std::vector<unsigned int> table(tableSize, 0);
+    std::vector<unsigned int> remap(count);
+    size_t kept = 0;
+    for (size_t v = 0; v < count; ++v) {
+        size_t slot = (size_t)Fnv1a(&vertices[v * stride], bytes) & (tableSize - 1);
+        while (table[slot] != 0 && std::memcmp(&vertices[(table[slot] - 1) * stride], &vertices[v * stride], bytes) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+        if (table[slot] == 0) {
+            // First of its kind: compact it down to its new place (kept <= v, so nothing unread is overwritten)
+            if (kept != v) std::memmove(&vertices[kept * stride], &vertices[v * stride], bytes);
+            table[slot] = (unsigned int)kept + 1;
+            remap[v] = (unsigned int)kept++;
+        } else {
+            remap[v] = table[slot] - 1;
+        }
+    }
+    vertices.resize(kept * stride);
+    for (unsigned int& index : indices) index = remap[index];
+    return count - kept;
+}
+
+// Drops triangles that cover no area because two corners share a position (first 3 floats).
+// Returns how many were removed.
+inline size_t RemoveDegenerateTriangles(const std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t stride) {
+    auto samePosition = [&](unsigned int a, unsigned int b) {
+        const float* p = &vertices[a * stride];
+        const float* q = &vertices[b * stride];
+        return p[0] == q[0] && p[1] == q[1] && p[2] == q[2];
+    };
+    size_t out = 0;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        unsigned int a = indices[t], b = indices[t + 1], c = indices[t + 2];
+        if (samePosition(a, b) || samePosition(b, c) || samePosition(a, c)) continue;
+        indices[out++] = a;
+        indices[out++] = b;
+        indices[out++] = c;
+    }
+    size_t removed = (indices.size() - out) / 3;
+    indices.resize(out);
+    return removed;
+}
+
+// Reorders the triangles for the post-transform vertex cache (Tom Forsyth, "Linear-Speed Vertex Cache
+// Optimisation"). Greedy: always emit the best scoring triangle, where vertices score for being recently
+// used (in the simulated cache) and for having few triangles left (so no lone triangles are left behind).
+inline void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) return;
+    const int CACHE = VERTEX_CACHE_MODEL_SIZE;
+
+    // Triangles of every vertex, packed: adjacency[offset[v] .. offset[v] + remaining[v]) are not emitted yet
+    std::vector<unsigned int> remaining(vertexCount, 0), offset(vertexCount + 1, 0), adjacency(triangleCount * 3);
+    for (size_t i = 0; i < triangleCount * 3; ++i) remaining[indices[i]]++;
+    for (size_t v = 0; v < vertexCount; ++v) offset[v + 1] = offset[v] + remaining[v];
+    std::vector<unsigned int> fill(offset.begin(), offset.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount), triangleScore(triangleCount, 0.0f);
+    std::vector<char> emitted(triangleCount, 0);
+    auto scoreOf = [&](size_t v) {
+        if (remaining[v] == 0) return -1.0f;
+        float score = 0.0f;
+        int position = cachePosition[v];
+        if (position >= 0) {
+            // The last triangle's 3 vertices score the same, so no strips are forced
+            if (position < 3) score = 0.75f;
+            else score = std::pow(1.0f - (float)(position - 3) / (float)(CACHE - 3), 1.5f);
+        }
+        return score + 2.0f / std::sqrt((float)remaining[v]);
+    };
+    for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = scoreOf(v);
+    for (size_t t = 0; t < triangleCount; ++t)
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+    std::vector<unsigned int> cache, nextCache, result;
+    cache.reserve(CACHE + 3);
+    nextCache.reserve(CACHE + 3);
+    result.reserve(indices.size());
+    long best = -1;
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+        if (best < 0) {
+            // Nothing left around the cache (start, or an island is done): best triangle anywhere
+            float bestScore = -1.0f;
+            for (size_t t = 0; t < triangleCount; ++t)
+                if (!emitted[t] && triangleScore[t] > bestScore) { bestScore = triangleScore[t]; best = (long)t; }
+        }
+        const unsigned int* corners = &indices[best * 3];
+        emitted[best] = 1;
+        result.insert(result.end(), corners, corners + 3);
+
+        // Take the triangle out of its vertices' lists, and put the vertices in front of the cache
+        nextCache.clear();
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = corners[k];
+            unsigned int* list = &adjacency[offset[v]];
+            for (unsigned int i = 0; i < remaining[v]; ++i)
+                if (list[i] == (unsigned int)best) { list[i] = list[--remaining[v]]; break; }
+            nextCache.push_back(v);
+        }
+        for (unsigned int v : cache)
+            if (v != corners[0] && v != corners[1] && v != corners[2]) nextCache.push_back(v);
+
+        // New scores for everything that moved in the cache (or fell out), best candidate on the way
+        best = -1;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            unsigned int v = nextCache[i];
+            cachePosition[v] = i < (size_t)CACHE ? (int)i : -1;
+            vertexScore[v] = scoreOf(v);
+        }
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            unsigned int v = nextCache[i];
+            for (unsigned int j = 0; j < remaining[v]; ++j) {
+                unsigned int t = adjacency[offset[v] + j];
+                triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (i < (size_t)CACHE && triangleScore[t] > bestScore) { bestScore = triangleScore[t]; best = (long)t; }
+            }
+        }
+        if (nextCache.size() > (size_t)CACHE) nextCache.resize(CACHE);
+        cache.swap(nextCache);
+    }
+    indices.swap(result);
+}
+
+// Renumbers the vertices in the order the indices first use them (and drops unused ones)
+inline void OptimizeVertexFetch(std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t stride) {
+    const size_t count = vertices.size() / stride;
+    std::vector<unsigned int> remap(count, ~0u);
+    std::vector<float> ordered;
+    ordered.reserve(vertices.size());
+    unsigned int next = 0;
+    for (unsigned int& index : indices) {
+        if (remap[index] == ~0u) {
+            remap[index] = next++;
+            ordered.insert(ordered.end(), vertices.begin() + index * stride, vertices.begin() + (index + 1) * stride);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+// Before/after numbers of every optimized mesh, printed once the scene is set up
+class MeshOptimizeStats {
+public:
+    class Entry {
+    public:
+        std::string name;
+        size_t verticesBefore = 0, verticesAfter = 0;
+        size_t trianglesBefore = 0, trianglesAfter = 0;
+        float acmrBefore = 0.0f, acmrAfter = 0.0f;
+        int meshes = 1; // identical meshes (same name and numbers) share an entry
+    };
+    static inline std::vector<Entry> entries;
+
+    static void Record(const Entry& entry) {
+        for (Entry& e : entries)
+            if (e.name == entry.name && e.verticesBefore == entry.verticesBefore && e.trianglesBefore == entry.trianglesBefore) {
+                e.meshes++;
+                return;
+            }
+        entries.push_back(entry);
+    }
+    static void Print() {
+        if (entries.empty()) return;
+        std::cout << "Mesh optimize (ACMR = vertex shader runs per triangle, FIFO " << VERTEX_CACHE_MEASURE_SIZE << "):\n";
+        for (const Entry& e : entries) {
+            std::cout << "  " << e.name;
+            if (e.meshes > 1) std::cout << " x" << e.meshes;
+            std::cout << ": vertices " << e.verticesBefore << " -> " << e.verticesAfter << ", triangles " << e.trianglesBefore
+                      << " -> " << e.trianglesAfter << std::fixed << std::setprecision(3) << ", ACMR " << e.acmrBefore << " -> "
+                      << e.acmrAfter << "\n";
+            std::cout.unsetf(std::ios::floatfield);
+        }
+    }
+};
+
+// The whole pass, in order. Returns (and records under name, when given) the before/after numbers.
+inline MeshOptimizeStats::Entry OptimizeMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t stride,
+                                             const char* name = nullptr) {
+    MeshOptimizeStats::Entry entry;
+    entry.name = name ? name : "";
+    entry.verticesBefore = vertices.size() / stride;
+    entry.trianglesBefore = indices.size() / 3;
+    entry.acmrBefore = ComputeACMR(indices, entry.verticesBefore);
+
+    WeldVertices(vertices, indices, stride);
+    RemoveDegenerateTriangles(vertices, indices, stride);
+    OptimizeVertexCache(indices, vertices.size() / stride);
+    OptimizeVertexFetch(vertices, indices, stride);
+
+    entry.verticesAfter = vertices.size() / stride;
+    entry.trianglesAfter = indices.size() / 3;
+    entry.acmrAfter = ComputeACMR(indices, entry.verticesAfter);
+    if (name) MeshOptimizeStats::Record(entry);
+    return entry;
+}
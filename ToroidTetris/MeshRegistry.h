@@ -0,0 +1,127 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <initializer_list>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include "Mesh.h"
+#include "MeshLOD.h"
+#include "Hash.h"
+
+/*
+Generated primitive meshes, shared. A generator with the same parameters is built and uploaded
+once; asking again hands back the same mesh (VAO, buffers, bounds), so setting a scene up again
+costs a hash lookup: no vertex building, no GL buffers, no heap allocation.
+Shared meshes are const: draw them, never UpdateVertices them. A renderer that adds its own
+per-instance attributes takes its own VAO over the shared buffers (Mesh::CreateVertexArray).
+Meshes live until the program ends, so keys hold shapes, not sizes: a size that changes at run
+time (the Tetris floor radius) goes in the model matrix over a unit mesh.
+*/
+
+enum class MeshGenerator { RubikCubie, Circle, CircleLOD, Sphere, SphereLOD };
+
+// Generator + its parameters as floats, compared bit for bit
+class MeshKey {
+public:
+    static const int MAX_PARAMS = 28;
+    MeshGenerator generator;
+    int count = 0;
+    float params[MAX_PARAMS] = {};
+
+    MeshKey(MeshGenerator g, std::initializer_list<float> values) : generator(g) {
+        for (float v : values)
+            if (count < MAX_PARAMS) params[count++] = v;
+    }
+    bool operator==(const MeshKey& other) const {
+        return generator == other.generator && count == other.count && std::memcmp(params, other.params, count * sizeof(float)) == 0;
+    }
+    class Hash {
+    public:
+        size_t operator()(const MeshKey& key) const {
+            // The generator, then the parameter bits
+            uint64_t hash = Fnv1a(&key.generator, sizeof(key.generator));
+            return (size_t)Fnv1a(key.params, key.count * sizeof(float), hash);
+        }
+    };
+};
+
+class MeshRegistry {
+public:
+    static inline int generated = 0;
+    static inline int reused = 0;
+
+    // The mesh for key, made by generate() the first time only
+    template <typename Generate>
+    static const Mesh& Get(const MeshKey& key, Generate generate) {
+        auto found = meshes.find(key);
+        if (found != meshes.end()) {
+            reused++;
+            return *found->second;
+        }
+        generated++;
+        auto inserted = meshes.emplace(key, std::make_unique<Mesh>(generate()));
+        return *inserted.first->second;
+    }
+    // The LOD chain for key, filled by build(chain) the first time only
+    template <typename Build>
+    static const MeshLOD& GetLOD(const MeshKey& key, Build build) {
+        auto found = chains.find(key);
+        if (found != chains.end()) return *found->second;
+        auto chain = std::make_unique<MeshLOD>();
+        build(*chain);
+        return *chains.emplace(key, std::move(chain)).first->second;
+    }
+
+    static const Mesh& RubikCubie(const UVRange& front, const UVRange& back, const UVRange& left, const UVRange& right,
+                                  const UVRange& bottom, const UVRange& top) {
+        MeshKey key(MeshGenerator::RubikCubie, {
+            front.uMin, front.vMin, front.uMax, front.vMax, back.uMin, back.vMin, back.uMax, back.vMax,
+            left.uMin, left.vMin, left.uMax, left.vMax, right.uMin, right.vMin, right.uMax, right.vMax,
+            bottom.uMin, bottom.vMin, bottom.uMax, bottom.vMax, top.uMin, top.vMin, top.uMax, top.vMax });
+        return Get(key, [&] { return CreateRubikCubieMesh(front, back, left, right, bottom, top); });
+    }
+    static const Mesh& Circle(float radius = 5.0f, int segments = 64, float y = 0.0f) {
+        MeshKey key(MeshGenerator::Circle, { radius, (float)segments, y });
+        return Get(key, [&] { return CreateCircleMesh(radius, segments, y); });
+    }
+
+    // Unit radius chain at y = 0 from segments down to 8, halving
+    static const MeshLOD& CircleLOD(int segments = 64) {
+        MeshKey key(MeshGenerator::CircleLOD, { (float)segments });
+        return GetLOD(key, [&](MeshLOD& lod) {
+            const int MIN_SEGMENTS = 8;
+            for (int s = segments;; s = std::max(s / 2, MIN_SEGMENTS)) {
+                lod.levels.push_back({ &Circle(1.0f, s, 0.0f), ChordError(1.0f, 2.0f * PI / s) });
+                if (s <= MIN_SEGMENTS) break;
+            }
+        });
+    }
+
+    static const Mesh& Sphere(float radius = 0.5f, int stacks = 12, int slices = 12) {
+        MeshKey key(MeshGenerator::Sphere, { radius, (float)stacks, (float)slices });
+        return Get(key, [&] { return CreateSphere(0.0f, 0.0f, 0.0f, radius, stacks, slices); });
+    }
+
+    // Unit radius chain from stacks x slices down to 4 x 4, halving
+    static const MeshLOD& SphereLOD(int stacks = 12, int slices = 12) {
+        MeshKey key(MeshGenerator::SphereLOD, { (float)stacks, (float)slices });
+        return GetLOD(key, [&](MeshLOD& lod) {
+            const int MIN_SEGMENTS = 4;
+            for (int st = stacks, sl = slices;; st = std::max(st / 2, MIN_SEGMENTS), sl = std::max(sl / 2, MIN_SEGMENTS)) {
+                // Between two rings (PI / stacks) and two meridians (2 PI / slices), both bound the facet error
+                float error = ChordError(1.0f, PI / st) + ChordError(1.0f, 2.0f * PI / sl);
+                lod.levels.push_back({ &Sphere(1.0f, st, sl), error });
+                if (st <= MIN_SEGMENTS && sl <= MIN_SEGMENTS) break;
+            }
+        });
+    }
+
+    static void PrintStats() {
+        std::cout << "Meshes: " << generated << " generated, " << reused << " reused\n";
+    }
+
+private:
+    static inline std::unordered_map<MeshKey, std::unique_ptr<Mesh>, MeshKey::Hash> meshes;
+    static inline std::unordered_map<MeshKey, std::unique_ptr<MeshLOD>, MeshKey::Hash> chains;
+};
@@ -0,0 +1,81 @@
+/*
+Full-board rebuild benchmark (TetrisRenderer::RebuildBoard): placing every block of a full board
+on the cylinder, old cosf/sinf per block vs the per-column table of CylinderLayout.
+Both write into a TransformStore like the renderer does. Wide boards are where the trig used to add up.
+Also checks that both give the same positions.
+
+Usage: BoardBench [rounds]   (build Release, the default of this project)
+*/
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "../CylinderLayout.h"
+#include "../TransformStore.h"
+
+static const float PI = 3.14159265359f;
+
+// Cubies::UpdateModelMatrix before the table, kept as the baseline
+static vec3 OldPosition(int gridX, int gridY, int width, float radius, float size) {
+    float angle = (float(gridX) / width) * 2.0f * PI;
+    return vec3(radius * cosf(angle), gridY * size, radius * sinf(angle));
+}
+
+// Keeps the compiler from dropping the work
+static volatile float g_sink;
+
+template <typename Fn>
+static double NanosecondsPerOp(size_t ops, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (double)ops;
+}
+
+int main(int argc, char** argv) {
+    size_t rounds = argc > 1 ? (size_t)std::atoll(argv[1]) : 2000;
+    const int HEIGHT = 22;
+    const float RADIUS = 12.0f, SIZE = 1.0f;
+    bool ok = true;
+
+    std::cout << "Full board rebuild, height " << HEIGHT << ", " << rounds << " rounds\n";
+    for (int width : { 10, 64, 256, 1024 }) {
+        CylinderLayout layout;
+        layout.Set(width, RADIUS, SIZE);
+        TransformStore store;
+        store.Reserve(width * HEIGHT);
+
+        float maxDiff = 0.0f;
+        for (int y = 0; y < HEIGHT; ++y)
+            for (int x = -width; x < 2 * width; ++x) { // also across the seam, like pieces can be
+                vec3 a = OldPosition(x, y, width, RADIUS, SIZE), b = layout.Position(x, y);
+                maxDiff = std::max(maxDiff, std::max(std::fabs(a.x - b.x), std::max(std::fabs(a.y - b.y), std::fabs(a.z - b.z))));
+            }
+        ok = ok && maxDiff < 1e-3f;
+
+        size_t blocks = rounds * width * HEIGHT;
+        double oldNs = NanosecondsPerOp(blocks, [&] {
+            for (size_t r = 0; r < rounds; ++r) {
+                store.Clear();
+                for (int y = 0; y < HEIGHT; ++y)
+                    for (int x = 0; x < width; ++x) store.Create(OldPosition(x, y, width, RADIUS, SIZE));
+                g_sink = store.models[(r * 16 + 12) % store.models.size()];
+            }
+        });
+        double tableNs = NanosecondsPerOp(blocks, [&] {
+            for (size_t r = 0; r < rounds; ++r) {
+                store.Clear();
+                for (int y = 0; y < HEIGHT; ++y)
+                    for (int x = 0; x < width; ++x) store.Create(layout.Position(x, y));
+                g_sink = store.models[(r * 16 + 12) % store.models.size()];
+            }
+        });
+        std::cout << "  width " << std::setw(5) << width << ": cosf/sinf " << std::fixed << std::setprecision(2) << std::setw(7)
+                  << oldNs << " ns/block, table " << std::setw(7) << tableNs << " ns/block   x" << oldNs / tableNs
+                  << "   (max difference " << std::scientific << std::setprecision(1) << maxDiff << ")\n";
+    }
+    std::cout << (ok ? "Positions match\n" : "Positions MISMATCH\n");
+    return ok ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <cmath>
 #include "Game.h"  // This already includes Camera.h, Mesh.h, Shader.h, MatrixOperations.h, etc.
+#include "RenderScheduler.h"
 
 // ===================================================================
 // GLOBAL GAME & RENDERER
@@ -19,12 +20,14 @@ float orbitAngleX = PI / 6.0f;
 const float orbitSpeed = 0.8f;
 
 float CustomRadius;
-// Time
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+// Only draws when something changed, sleeps until the next gravity tick otherwise
+RenderScheduler g_scheduler;
+
+// Framebuffer height in pixels, for the floor's level of detail
+int g_framebufferHeight = 900;
 
 // Gravity timer 
-float fallTimer = 0.0f;
+double nextFallTime = 0.0; // glfwGetTime() of the next drop
 float fallDelay = 0.8f;  // seconds per drop 
 
 // ===================================================================
@@ -32,9 +35,18 @@ float fallDelay = 0.8f;  // seconds per drop
 // ===================================================================
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    g_framebufferHeight = height;
+    g_scheduler.RequestRedraw();
+}
+
+// Window uncovered / resized, the old frame is gone
+void window_refresh_callback(GLFWwindow* window) {
+    g_scheduler.RequestRedraw();
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    // Every key can change what is on screen, draw one frame for it
+    g_scheduler.RequestRedraw();
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
@@ -42,12 +54,13 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     if (key == GLFW_KEY_Q && action == GLFW_PRESS) ORBIT_RADIUS = std::max(10.0f, ORBIT_RADIUS - 3.0f);
     if (key == GLFW_KEY_E && action == GLFW_PRESS) ORBIT_RADIUS += 3.0f;
 
-    // Camera orbit (hold keys)
+    // Camera orbit (hold keys). Fixed step per key event (the old 60 fps step),
+    // the frame time means nothing here since frames only run when needed.
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
-        if (key == GLFW_KEY_A) orbitAngleY += orbitSpeed * deltaTime * 60.0f;
-        if (key == GLFW_KEY_D) orbitAngleY -= orbitSpeed * deltaTime * 60.0f;
-        if (key == GLFW_KEY_W) orbitAngleX = std::min(PI/2.0f - 0.1f, orbitAngleX + orbitSpeed * deltaTime * 60.0f);
-        if (key == GLFW_KEY_S) orbitAngleX = std::max(-PI/2.0f + 0.1f, orbitAngleX - orbitSpeed * deltaTime * 60.0f);
+        if (key == GLFW_KEY_A) orbitAngleY += orbitSpeed;
+        if (key == GLFW_KEY_D) orbitAngleY -= orbitSpeed;
+        if (key == GLFW_KEY_W) orbitAngleX = std::min(PI/2.0f - 0.1f, orbitAngleX + orbitSpeed);
+        if (key == GLFW_KEY_S) orbitAngleX = std::max(-PI/2.0f + 0.1f, orbitAngleX - orbitSpeed);
     }
 
     // === TETRIS CONTROLS (only on PRESS) ===
@@ -88,6 +101,10 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 			g_renderer->SetRadius(CustomRadius);
 			std::cout << "RAD -" << CustomRadius <<"\n";
 			break;
+		case GLFW_KEY_P:
+			g_scheduler.PrintStats();
+			CullStats::Print();
+			break;
     }
 }
 
@@ -107,7 +124,10 @@ int main() {
 
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    int framebufferWidth = 0;
+    glfwGetFramebufferSize(window, &framebufferWidth, &g_framebufferHeight); // HiDPI: not the window size
     glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     if (!gladLoadGL(glfwGetProcAddress)) {
         std::cerr << "Failed to initialize GLAD\n"; return -1;
@@ -120,6 +140,7 @@ int main() {
     // Shader
     Shader shader("simple.vs", "simple.fs");
     g_shader = &shader;
+    ProgramCache::PrintStats();
     shader.use();
     shader.setInt("entryTexture", 0);
 	glEnable(GL_BLEND);
@@ -147,21 +168,25 @@ int main() {
     g_tetrisGame.start();
     g_renderer = new TetrisRenderer(g_tetrisGame, shader);
     g_renderer->SetRadius(2.0f);
+    MeshOptimizeStats::Print();
+    MeshRegistry::PrintStats();
 	float CustomRadius = 2;
     Camera camera(vec3(0, 10, 30));
 
     // ===================================================================
     // MAIN LOOP
     // ===================================================================
+    nextFallTime = glfwGetTime() + fallDelay;
     while (!glfwWindowShouldClose(window)) {
-        float currentTime = glfwGetTime();
-        deltaTime = currentTime - lastFrame;
-        lastFrame = currentTime;
+        // Input & sleep: nothing moves between gravity ticks unless a key is pressed
+        g_scheduler.WakeAt(nextFallTime);
+        g_scheduler.WaitForWork();
 
         // Auto-fall (gravity)
-        fallTimer += deltaTime;
-        if (fallTimer >= fallDelay) {
-            fallTimer = 0.0f;
+        double currentTime = glfwGetTime();
+        if (currentTime >= nextFallTime) {
+            nextFallTime = currentTime + fallDelay;
+            g_scheduler.RequestRedraw();
             if (!g_tetrisGame.move(0, -1)) {
                 g_tetrisGame.lockCurrent();
                 g_renderer->RebuildBoard();
@@ -173,8 +198,10 @@ int main() {
             }
         }
 
-        // Input & camera
-        glfwPollEvents();
+        if (!g_scheduler.ShouldRender()) continue;
+        g_scheduler.BeginFrame();
+
+        // Camera
         camera.Orbit(orbitAngleY, orbitAngleX, ORBIT_RADIUS, vec3(0, 8, 0));  // look slightly down
 
         // Clear
@@ -186,11 +213,14 @@ int main() {
         projection.Perspective(45.0f * (PI/180.0f), 600.0f / 900.0f, 0.1f, 200.0f);
 		
         // Render
-        g_renderer->Render(camera, projection);
+        g_renderer->Render(camera, projection, (float)g_framebufferHeight);
 
         glfwSwapBuffers(window);
+        g_scheduler.EndFrame();
     }
 
+    g_scheduler.PrintStats();
+    CullStats::Print();
     delete g_renderer;
     glfwTerminate();
     return 0;
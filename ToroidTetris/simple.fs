@@ -27,11 +27,19 @@ struct Material {
     float shininess;
 };
 
-uniform Light light;
-uniform Material material;
+// Shared by every program (UniformBlocks.h), std140 layout
+layout (std140) uniform Lighting {
+    Light light;
+    Material material;
+};
 uniform float opacity;
 
-uniform vec3 viewPos; // Camera position
+// Shared by every program, one buffer per frame (UniformBlocks.h)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos; // Camera position
+};
 
 void main() {
     if (mode == 1)
@@ -10,8 +10,13 @@ out vec3 Normal;
 out vec3 FragPos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix; // transpose(inverse(model)), computed on the CPU (matrix4::NormalMatrix)
+// Shared by every program, one buffer per frame (UniformBlocks.h)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos; // Camera position
+};
 
 void main()
 {
@@ -20,5 +25,5 @@ void main()
     
     // Transform position and normal to world space and pass them on
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal; // Normal transformation
+    Normal = normalMatrix * aNormal; // Normal transformation
 }
\ No newline at end of file